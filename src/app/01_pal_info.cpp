@@ -1,6 +1,6 @@
 #include <iostream>
 #include "../format/Pal.hpp"
-#include "../util/filehandler.hpp"
+#include "../util/MappedFile.hpp"
 
 using namespace std;
 using namespace format;
@@ -13,7 +13,7 @@ int main(int argc, const char* argv[])
     }
 
     try {
-        Pal pal(readFile(argv[1]));
+        Pal pal(mapFile(argv[1]));
         
         cout << "Pal file '" << argv[1] << "' loaded:" << endl;
         cout << "  colors: " << pal.colors.size() << endl;
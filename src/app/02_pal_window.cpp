@@ -2,7 +2,7 @@
 #include <string>
 #include <glad/glad.h>
 #include "../format/Pal.hpp"
-#include "../util/filehandler.hpp"
+#include "../util/MappedFile.hpp"
 #include "../window/Window.hpp"
 
 using namespace std;
@@ -59,7 +59,7 @@ int main(int argc, const char* argv[])
     }
 
     try {
-        Pal pal(readFile(argv[1]));
+        Pal pal(mapFile(argv[1]));
         PalWindow win(move(pal));
         
         if (!win.show(16 * 20, 16 * 20, argv[1])) {
@@ -1,6 +1,5 @@
 #include <iostream>
-#include "../format/Spr.hpp"
-#include "../util/filehandler.hpp"
+#include "../format/LazySpr.hpp"
 
 using namespace std;
 using namespace format;
@@ -13,19 +12,19 @@ int main(int argc, const char* argv[])
     }
 
     try {
-        // Try opening the file and creating spr object
-        Spr spr(readFile(argv[1]));
+        // Only image sizes are shown, so nothing needs decoding
+        LazySpr spr(argv[1]);
 
         cout << "Spr file '" << argv[1] << "' loaded:" << endl;
         cout << "  version: " << spr.version.major << '.' << spr.version.minor << endl;
-        cout << "  palette images: " << spr.palette_images.size() << endl;
+        cout << "  palette images: " << spr.paletteImageInfos().size() << endl;
 
-        for (const Spr::PaletteImage& img : spr.palette_images)
+        for (const LazySpr::ImageInfo& img : spr.paletteImageInfos())
             cout << "   - " << img.width << 'x' << img.height << " pixels" << endl;
 
-        cout << "  rgba images: " << spr.rgba_images.size() << endl;
+        cout << "  rgba images: " << spr.rgbaImageInfos().size() << endl;
 
-        for (const Spr::RgbaImage& img : spr.rgba_images)
+        for (const LazySpr::ImageInfo& img : spr.rgbaImageInfos())
             cout << "    - " << img.width << 'x' << img.height << " pixels" << endl;
 
         cout << "  palette colors: " << (spr.pal ? spr.pal->colors.size() : 0) << endl;
@@ -1,9 +1,10 @@
 #include <iostream>
 #include <vector>
 #include <glad/glad.h>
+#include "../format/PalLut.hpp"
 #include "../format/Spr.hpp"
 #include "../gl/Texture.hpp"
-#include "../util/filehandler.hpp"
+#include "../util/MappedFile.hpp"
 #include "../window/Window.hpp"
 
 using namespace std;
@@ -26,22 +27,15 @@ private:
 
 void SprWindow::setup()
 {
-    for (const Spr::PaletteImage& img : spr_.palette_images)
+    if (spr_.pal)
     {
-        if (spr_.pal)
-        {
-            vector<uint8_t> pixels(img.indices.size() * 4);
-
-            for (int i = 0; i < img.indices.size(); i++)
-            {
-                uint8_t index = img.indices[i];
-                const Color& color = spr_.pal->colors[index];
+        const PalLut lut(*spr_.pal, PalLut::PalAlpha);
+        vector<uint8_t> pixels;
 
-                pixels[i*4 + 0] = color.r;
-                pixels[i*4 + 1] = color.g;
-                pixels[i*4 + 2] = color.b;
-                pixels[i*4 + 3] = color.a;
-            }
+        for (const Spr::PaletteImage& img : spr_.palette_images)
+        {
+            pixels.resize(img.indices.size() * 4);
+            lut.expand(img.indices.data(), img.indices.size(), pixels.data());
 
             textures_.emplace_back(Texture(img.width, img.height, Texture::Rgba, pixels.data()));
         }
@@ -99,7 +93,7 @@ int main(int argc, const char* argv[])
     }
 
     try {
-        Spr spr(readFile(argv[1]));
+        Spr spr(mapFile(argv[1]));
         SprWindow win(move(spr));
 
         if (!win.show(800, 600, argv[1])) {
@@ -2,7 +2,7 @@
 #include <cstring>
 #include <iostream>
 #include "../format/Act.hpp"
-#include "../util/filehandler.hpp"
+#include "../util/MappedFile.hpp"
 
 using namespace std;
 using namespace format;
@@ -31,7 +31,7 @@ int main(int argc, const char* argv[])
 
     try {
         // Try opening the file and creating act object
-        Act act(readFile(filename));
+        Act act(mapFile(filename));
 
         cout << "Act file '" << filename << "' loaded with verbosity " << verbosity << ":" << endl;
         cout << "  version: " << act.version.major << '.' << act.version.minor << endl;
@@ -1,11 +1,12 @@
 #include <cstring>
 #include <iostream>
 #include <glad/glad.h>
-#include "../format/Act.hpp"
+#include "../format/FlatAct.hpp"
 #include "../format/Spr.hpp"
 #include "../gl/ROSprite.hpp"
+#include "../gl/SharedResources.hpp"
 #include "../gl/Texture.hpp"
-#include "../util/filehandler.hpp"
+#include "../util/MappedFile.hpp"
 #include "../window/Window.hpp"
 
 using namespace std;
@@ -31,6 +32,7 @@ private:
     void draw() override;
     void drawCoordinateAxes();
 
+    SharedResources shared_resources_; // first, so it's destroyed last
     ROSprite sprite_;
     int center_x_, center_y_;
     bool animating_ = true;
@@ -131,12 +133,15 @@ void ActViewer::drawCoordinateAxes()
 
 int main(int argc, const char* argv[])
 {
-    if (argc < 2) {
-        cout << "Usage: " << argv[0] << " <act file>" << endl;
+    const bool palette_mode = argc >= 2 && strcmp(argv[1], "-p") == 0;
+
+    if (argc - palette_mode < 2) {
+        cout << "Usage: " << argv[0] << " [-p] <act file>" << endl;
+        cout << "  -p  resolve palette indices in a shader instead of uploading RGBA textures" << endl;
         return 1;
     }
 
-    const char* filename = argv[1];
+    const char* filename = argv[1 + palette_mode];
     const size_t filename_size = strlen(filename);
 
     if (filename_size < 3) {
@@ -145,12 +150,12 @@ int main(int argc, const char* argv[])
     }
 
     try {
-        Act act(readFile(filename));
+        FlatAct act(mapFile(filename));
         
         // Replace "act" extension with "spr"
         memcpy(const_cast<char*>(&filename[filename_size - 3]), "spr", 3);
         
-        Spr spr(readFile(filename));
+        Spr spr(mapFile(filename), Spr::Allocation::Arena);
 
         if (!spr.pal) {
             cout << "File '" << filename << "' has no palette" << endl;
@@ -158,6 +163,8 @@ int main(int argc, const char* argv[])
         }
 
         ROSprite sprite(act, spr, *spr.pal);
+        sprite.setPaletteMode(palette_mode);
+        sprite.setSourcePath(filename);
         ActViewer viewer(move(sprite));
 
         if (!viewer.show(800, 600, "Act viewer")) {
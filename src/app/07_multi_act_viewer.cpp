@@ -1,13 +1,17 @@
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstring>
 #include <iostream>
 #include <memory>
 #include <glad/glad.h>
-#include "../format/Act.hpp"
+#include "../format/FlatAct.hpp"
 #include "../format/Spr.hpp"
 #include "../gl/ROSprite.hpp"
+#include "../gl/SharedResources.hpp"
+#include "../gl/TextureManager.hpp"
 #include "../gl/Texture.hpp"
-#include "../util/filehandler.hpp"
+#include "../util/MappedFile.hpp"
 #include "../window/Window.hpp"
 
 using namespace std;
@@ -60,6 +64,7 @@ private:
     void drawCoordinateAxes();
     void drawSprites();
 
+    SharedResources shared_resources_; // first, so it's destroyed last
     // Sprites in their anchor dependency order i.e. sprites_[0] has no dependency
     vector<ROSprite> sprites_;
 
@@ -158,6 +163,10 @@ void MultiActViewer::onKeyEvent(KeyEvent evt)
                 
             cout << "using minifying filter: " << resizeFilterName(min_filter) << endl;
         } break;
+
+        case Key::S:
+            cout << TextureManager::shared().stats() << endl;
+            break;
     }
 
     if (changed_animation)
@@ -207,19 +216,41 @@ void MultiActViewer::drawCoordinateAxes()
 
 void MultiActViewer::drawSprites()
 {
+    const float scale = scale_per_ / 100.f;
+
+    // Viewport in sprite coordinates, so that sprites entirely outside of it are skipped
+    FlatAct::Bounds viewport;
+
+    if (scale_per_ != 0)
+    {
+        const float x0 = -center_x_ / scale;
+        const float x1 = (width() - center_x_) / scale;
+        const float y0 = -center_y_ / scale;
+        const float y1 = (height() - center_y_) / scale;
+
+        viewport = {
+            static_cast<int>(floor(min(x0, x1))), static_cast<int>(floor(min(y0, y1))),
+            static_cast<int>(ceil(max(x0, x1))), static_cast<int>(ceil(max(y0, y1)))
+        };
+    }
+
     glPushMatrix();
     glTranslated(center_x_, center_y_, 0);
-    glScalef(scale_per_ / 100.f, scale_per_ / 100.f, scale_per_ / 100.f);
+    glScalef(scale, scale, scale);
     
     auto sprite_iter = sprites_.cbegin();
     const ROSprite& body_sprite = *sprite_iter;
 
     // The body sprite has no anchor
-    body_sprite.draw();
+    if (body_sprite.currentBounds().intersects(viewport))
+        body_sprite.draw();
 
     // Draw every other sprite using the body one as its anchor
     while (++sprite_iter != sprites_.cend())
-        sprite_iter->draw(body_sprite);
+    {
+        if (sprite_iter->currentBounds(body_sprite).intersects(viewport))
+            sprite_iter->draw(body_sprite);
+    }
 
     glPopMatrix();
 }
@@ -250,7 +281,7 @@ int main(int argc, const char* argv[])
         vector<ROSprite> sprites;
 
         // Needed since Sprite class neither own Spr nor Act objects
-        vector<unique_ptr<Act>> acts;
+        vector<unique_ptr<FlatAct>> acts;
         vector<unique_ptr<Spr>> sprs;
 
         // Tries opening every .act and .spr for each given .act
@@ -258,16 +289,19 @@ int main(int argc, const char* argv[])
         {
             char* filename = const_cast<char*>(argv[i]);
 
-            auto act = make_unique<Act>(readFile(filename));
+            auto act = make_unique<FlatAct>(mapFile(filename));
             memcpy(&filename[strlen(filename) - 3], "spr", 3);
-            auto spr = make_unique<Spr>(readFile(filename));
+            auto spr = make_unique<Spr>(mapFile(filename), Spr::Allocation::Arena);
 
             if (!spr->pal) {
                 cout << "File '" << filename << "' has no palette, skipping..." << endl;
                 continue;
             }
 
-            sprites.emplace_back(ROSprite(*act, *spr, *(spr->pal)));
+            ROSprite sprite(*act, *spr, *(spr->pal));
+            sprite.setSourcePath(filename);
+
+            sprites.emplace_back(move(sprite));
             acts.emplace_back(move(act));
             sprs.emplace_back(move(spr));
         }
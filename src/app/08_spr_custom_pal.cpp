@@ -4,8 +4,11 @@
 #include <glad/glad.h>
 #include "../format/Spr.hpp"
 #include "../format/Pal.hpp"
+#include "../format/PalLut.hpp"
+#include "../gl/PaletteShader.hpp"
+#include "../gl/SharedResources.hpp"
 #include "../gl/Texture.hpp"
-#include "../util/filehandler.hpp"
+#include "../util/MappedFile.hpp"
 #include "../window/Window.hpp"
 
 using namespace std;
@@ -22,7 +25,7 @@ public:
     void setup();
 
 private:
-    void setTextures(const Pal& pal);
+    void setPalette(const Pal& pal);
     void showCommands();
 
     void onKeyEvent(KeyEvent evt) override;
@@ -31,9 +34,11 @@ private:
     void drawCoordinateAxes();
     void drawSprite();
 
+    SharedResources shared_resources_; // first, so it's destroyed last
     Spr spr_;
     vector<Pal> pals_;
     vector<Texture> textures_;
+    Texture palette_texture_;
     int current_pal_idx_ = 0;
     int current_tex_idx_ = 0;
     bool use_custom_pal_ = true;
@@ -44,8 +49,17 @@ private:
 
 void SprCustomPalWindow::setup()
 {
+    // Upload indices once, so swapping palettes only uploads the palette texture
+    for (const Spr::PaletteImage& img : spr_.palette_images)
+    {
+        Texture texture(img.width, img.height, Texture::Gray, img.indices.data());
+        texture.setResizeFilters(Texture::Nearest, Texture::Nearest);
+
+        textures_.emplace_back(std::move(texture));
+    }
+
     // Use custom palette by default
-    setTextures(pals_.front());
+    setPalette(pals_.front());
     showCommands();
 
     center_x_ = width() / 2;
@@ -58,37 +72,12 @@ void SprCustomPalWindow::setup()
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
-void SprCustomPalWindow::setTextures(const Pal& pal)
+void SprCustomPalWindow::setPalette(const Pal& pal)
 {
-    // Create textures if they weren't previously created
-    if (textures_.empty())
-        textures_.resize(spr_.palette_images.size());
-
-    auto texture_iter = textures_.begin();
-
-    for (const Spr::PaletteImage& img : spr_.palette_images)
-    {
-        vector<uint8_t> pixels(img.indices.size() * 4);
-        const Color& transp_color = pal.colors[0];
-
-        for (int i = 0; i < img.indices.size(); i++)
-        {
-            uint8_t index = img.indices[i];
-            const Color& color = pal.colors[index];
-
-            pixels[i*4 + 0] = color.r;
-            pixels[i*4 + 1] = color.g;
-            pixels[i*4 + 2] = color.b;
-            pixels[i*4 + 3] = 
-                color.r == transp_color.r &&
-                color.g == transp_color.g &&
-                color.b == transp_color.b ?
-                0 : 255;
-        }
+    const PalLut lut(pal, PalLut::KeyedFirstColor);
 
-        texture_iter->load(img.width, img.height, Texture::Rgba, pixels.data());
-        texture_iter++;
-    }
+    palette_texture_.load(256, 1, Texture::Rgba, lut.data());
+    palette_texture_.setResizeFilters(Texture::Nearest, Texture::Nearest);
 }
 
 void SprCustomPalWindow::showCommands()
@@ -128,14 +117,14 @@ void SprCustomPalWindow::onKeyEvent(KeyEvent evt)
 
         case Key::Up:
             if (use_custom_pal_ && pals_.size() >= 2 && current_pal_idx_ < (pals_.size() - 1))
-                setTextures(pals_[++current_pal_idx_]);
+                setPalette(pals_[++current_pal_idx_]);
 
             cout << "custom palette: " << (current_pal_idx_ + 1) << '/' << pals_.size() << endl;
             break;
 
         case Key::Down:
             if (use_custom_pal_ && pals_.size() >= 2 && current_pal_idx_ > 0)
-                setTextures(pals_[--current_pal_idx_]);
+                setPalette(pals_[--current_pal_idx_]);
 
             cout << "custom palette: " << (current_pal_idx_ + 1) << '/' << pals_.size() << endl;
             break;
@@ -149,9 +138,9 @@ void SprCustomPalWindow::onKeyEvent(KeyEvent evt)
             use_custom_pal_ = !use_custom_pal_;
 
             if (use_custom_pal_)
-                setTextures(pals_[current_pal_idx_]);
+                setPalette(pals_[current_pal_idx_]);
             else
-                setTextures(*spr_.pal);
+                setPalette(*spr_.pal);
 
             cout << "palette type: " << (use_custom_pal_ ? "custom" : "sprite") << endl;
             break;
@@ -202,6 +191,11 @@ void SprCustomPalWindow::drawSprite()
     const int w = img.width;
     const int h = img.height;
     
+    PaletteShader::shared().use();
+
+    glActiveTexture(PaletteShader::palette_unit);
+    palette_texture_.bind();
+    glActiveTexture(PaletteShader::indices_unit);
     textures_[current_tex_idx_].bind();
     
     glBegin(GL_QUADS);
@@ -212,6 +206,11 @@ void SprCustomPalWindow::drawSprite()
     glEnd();
     
     Texture::unbind();
+    glActiveTexture(PaletteShader::palette_unit);
+    Texture::unbind();
+    glActiveTexture(PaletteShader::indices_unit);
+
+    PaletteShader::unuse();
 
     glPopMatrix();
 }
@@ -226,12 +225,12 @@ int main(int argc, const char* argv[])
     }
 
     try {
-        Spr spr(readFile(argv[1]));
+        Spr spr(mapFile(argv[1]));
         
         vector<Pal> pals;
 
         for (int i = 2; i < argc; i++)
-            pals.emplace_back(Pal(readFile(argv[i])));
+            pals.emplace_back(Pal(mapFile(argv[i])));
 
         SprCustomPalWindow win(move(spr), move(pals));
 
@@ -4,9 +4,11 @@
 #include <string>
 #include <string_view>
 #include "../format/Image.hpp"
+#include "../format/PalLut.hpp"
 #include "../format/Spr.hpp"
 #include "../util/Buffer.hpp"
 #include "../util/filehandler.hpp"
+#include "../util/MappedFile.hpp"
 
 using namespace std;
 using namespace format;
@@ -40,7 +42,7 @@ int main(int argc, const char* argv[])
     
     try {
         // Try opening the file and creating spr object
-        Spr spr(readFile(spr_fn));
+        Spr spr(mapFile(spr_fn));
 
         // Remove the path from spr filename if any.
         if (const char* p = strrchr(argv[1], '/'))
@@ -63,23 +65,16 @@ int main(int argc, const char* argv[])
 
         if (spr.pal)
         {
+            const PalLut lut(*spr.pal, PalLut::Opaque);
+            std::vector<uint8_t> pixels;
+
             for (int i = 0; i < spr.palette_images.size(); i++)
             {
                 const Spr::PaletteImage& image = spr.palette_images[i];
-                
-                std::vector<uint8_t> pixels(image.indices.size() * 4);
 
                 // Generate the pixels from the combination of indices and palette colors.
-                for (int j = 0; j < image.indices.size(); j++)
-                {
-                    uint8_t index = image.indices[j];
-                    const Color& color = spr.pal->colors[index];
-                    
-                    pixels[j*4 + 0] = color.r;
-                    pixels[j*4 + 1] = color.g;
-                    pixels[j*4 + 2] = color.b;
-                    pixels[j*4 + 3] = 255;
-                }
+                pixels.resize(image.indices.size() * 4);
+                lut.expand(image.indices.data(), image.indices.size(), pixels.data());
                 
                 // filename.spr -> path/filename_i.bmp
                 exportBmpFile(bmp_path, spr_name + '_' + to_string(i+1) + ".bmp", image.width, image.height, 4, pixels.data());
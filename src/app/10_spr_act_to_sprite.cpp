@@ -6,6 +6,7 @@
 #include "../format/Spr.hpp"
 #include "../format/Sprite.hpp"
 #include "../util/filehandler.hpp"
+#include "../util/MappedFile.hpp"
 
 using namespace std;
 using namespace format;
@@ -24,7 +25,7 @@ Sprite toSprite(Act act, Spr spr)
     {
         sprite.images[i].width = spr.palette_images[i].width;
         sprite.images[i].height = spr.palette_images[i].height;
-        sprite.images[i].indices = move(spr.palette_images[i].indices);
+        sprite.images[i].indices.assign(spr.palette_images[i].indices.begin(), spr.palette_images[i].indices.end());
     }
     
     // Sounds
@@ -84,12 +85,16 @@ Sprite toSprite(Act act, Spr spr)
 
 int main(int argc, const char* argv[])
 {
-    if (argc < 3) {
-        cout << "Usage: " << argv[0] << " <act file> <sprite file>" << endl;
+    const bool indexed = argc >= 2 && strcmp(argv[1], "-2") == 0;
+
+    if (argc - indexed < 3) {
+        cout << "Usage: " << argv[0] << " [-2] <act file> <sprite file>" << endl;
+        cout << "  -2  save in version 2, indexed and compressed (default: version 1)" << endl;
         return 1;
     }
 
-    const char* filename = argv[1];
+    const char* filename = argv[1 + indexed];
+    const char* sprite_filename = argv[2 + indexed];
     size_t filename_len = strlen(filename);
 
     if (filename_len < 3) {
@@ -98,9 +103,9 @@ int main(int argc, const char* argv[])
     }
 
     try {
-        Act act(readFile(filename));
+        Act act(mapFile(filename));
         memcpy(const_cast<char*>(&filename[filename_len - 3]), "spr", 3);
-        Spr spr(readFile(filename));
+        Spr spr(mapFile(filename));
 
         if (!spr.pal) {
             cout << "File '" << filename << "' has no palette" << endl;
@@ -109,13 +114,14 @@ int main(int argc, const char* argv[])
 
         // Create sprite out of act and spr
         Sprite sprite = toSprite(move(act), move(spr));
+        sprite.version = (indexed ? 2 : 1);
 
         // Serialize sprite obj to buffer
         Buffer buf;
         sprite.save(buf);
 
-        writeFile(argv[2], buf);
-        cout << "Exported sprite: " << argv[2] << endl;
+        writeFile(sprite_filename, buf);
+        cout << "Exported sprite: " << sprite_filename << endl;
     }
     catch (const exception& e) {
         cout << "Exception: " << e.what() << endl;
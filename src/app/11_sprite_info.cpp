@@ -2,7 +2,7 @@
 #include <cstring>
 #include <iostream>
 #include "../format/Sprite.hpp"
-#include "../util/filehandler.hpp"
+#include "../util/MappedFile.hpp"
 
 using namespace std;
 using namespace format;
@@ -31,7 +31,7 @@ int main(int argc, const char* argv[])
 
     try {
         // Try opening the file and creating sprite object
-        Sprite sprite(readFile(filename));
+        Sprite sprite(mapFile(filename));
 
         cout << "Sprite file '" << filename << "' loaded with verbosity " << verbosity << ":" << endl;
 
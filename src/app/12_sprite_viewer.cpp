@@ -1,10 +1,10 @@
 #include <cstring>
 #include <iostream>
 #include <glad/glad.h>
-#include "../format/Sprite.hpp"
+#include "../format/SpriteView.hpp"
 #include "../gl/ApolloSprite.hpp"
+#include "../gl/SharedResources.hpp"
 #include "../gl/Texture.hpp"
-#include "../util/filehandler.hpp"
 #include "../window/Window.hpp"
 
 using namespace std;
@@ -30,6 +30,7 @@ private:
     void draw() override;
     void drawCoordinateAxes();
 
+    SharedResources shared_resources_; // first, so it's destroyed last
     ApolloSprite sprite_;
     int center_x_, center_y_;
     bool animating_ = true;
@@ -130,15 +131,20 @@ void SpriteViewer::drawCoordinateAxes()
 
 int main(int argc, const char* argv[])
 {
-    if (argc < 2) {
-        cout << "Usage: " << argv[0] << " <sprite file>" << endl;
+    const bool palette_mode = argc >= 2 && strcmp(argv[1], "-p") == 0;
+
+    if (argc - palette_mode < 2) {
+        cout << "Usage: " << argv[0] << " [-p] <sprite file>" << endl;
+        cout << "  -p  resolve palette indices in a shader instead of uploading RGBA textures" << endl;
         return 1;
     }
 
     try {
-        format::Sprite sprite(readFile(argv[1]));
+        const SpriteView sprite(argv[1 + palette_mode]);
 
         ApolloSprite ap_sprite(sprite, sprite.pal);
+        ap_sprite.setPaletteMode(palette_mode);
+        ap_sprite.setSourcePath(argv[1 + palette_mode]);
         SpriteViewer viewer(move(ap_sprite));
 
         if (!viewer.show(800, 600, "Sprite viewer")) {
@@ -1,6 +1,6 @@
 #include <iostream>
 #include "../format/Str.hpp"
-#include "../util/filehandler.hpp"
+#include "../util/MappedFile.hpp"
 
 using namespace std;
 using namespace format;
@@ -13,7 +13,7 @@ int main(int argc, const char* argv[])
     }
 
     try {
-        Str str(readFile(argv[1]));
+        Str str(mapFile(argv[1]));
         
         cout << "Str file '" << argv[1] << "' loaded:" << endl;
         cout << "  version: " << str.version << endl;
@@ -1,10 +1,15 @@
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <glad/glad.h>
+#include "../format/Grf.hpp"
 #include "../format/Str.hpp"
 #include "../gl/Effect.hpp"
+#include "../gl/SharedResources.hpp"
 #include "../gl/Texture.hpp"
-#include "../util/filehandler.hpp"
+#include "../gl/TextureManager.hpp"
+#include "../util/MappedFile.hpp"
+#include "../util/ThreadPool.hpp"
 #include "../window/Window.hpp"
 
 using namespace std;
@@ -13,7 +18,7 @@ using namespace gl;
 
 class StrViewer : public Window {
 public:
-    void setup(const Str& str, const char* texture_path);
+    void setup(const Str& str, const char* texture_path, const Grf* grf = nullptr);
 
 private:
     void onKeyEvent(KeyEvent evt) override;
@@ -27,14 +32,19 @@ private:
     void draw() override;
     void drawCoordinateAxes();
 
+    SharedResources shared_resources_; // first, so it's destroyed last
+    ThreadPool pool_;
     Effect effect_;
     int center_x_, center_y_;
     bool animating_ = false;
 };
 
-void StrViewer::setup(const Str& str, const char* texture_path)
+void StrViewer::setup(const Str& str, const char* texture_path, const Grf* grf)
 {
-    effect_.load(str, texture_path);
+    if (grf)
+        effect_.load(str, *grf, texture_path, pool_);
+    else
+        effect_.load(str, texture_path, pool_);
 
     center_x_ = width() / 2;
     center_y_ = height() / 2;
@@ -78,6 +88,15 @@ void StrViewer::onKeyEvent(KeyEvent evt)
             effect_.showBorder(!effect_.showingBorder());
             cout << "showing border: " << std::boolalpha << effect_.showingBorder() << endl;
             break;
+
+        case Key::T:
+            effect_.setBaked(!effect_.baked());
+            cout << "baked timeline: " << std::boolalpha << effect_.baked() << endl;
+            break;
+
+        case Key::S:
+            cout << TextureManager::shared().stats() << endl;
+            break;
     }
 
     if (changed_animation)
@@ -125,13 +144,30 @@ void StrViewer::drawCoordinateAxes()
 
 int main(int argc, const char* argv[])
 {
-    if (argc < 3) {
-        cout << "Usage: " << argv[0] << " <str file> <textures path>" << endl;
+    // Resolve the str file and its textures inside a grf archive if requested
+    const bool use_grf = argc > 1 && strcmp(argv[1], "-g") == 0;
+    const int arg_offset = use_grf ? 2 : 0;
+
+    if (argc < 3 + arg_offset) {
+        cout << "Usage: " << argv[0] << " [-g <grf file>] <str file> <textures path>" << endl;
+        cout << "With -g, both the str file and the textures path are looked up in the grf archive." << endl;
         return 1;
     }
 
+    const char* str_fn = argv[1 + arg_offset];
+    const char* texture_path = argv[2 + arg_offset];
+
     try {
-        Str str(readFile(argv[1]));
+        unique_ptr<Grf> grf;
+        Str str;
+
+        if (use_grf) {
+            grf = make_unique<Grf>(argv[2]);
+            str.load(grf->read(str_fn));
+        }
+        else
+            str.load(mapFile(str_fn));
+
         StrViewer viewer;
 
         if (!viewer.show(1024, 768, "Str viewer")) {
@@ -139,7 +175,7 @@ int main(int argc, const char* argv[])
             return 1;
         }
 
-        viewer.setup(str, argv[2]);
+        viewer.setup(str, texture_path, grf.get());
         viewer.loop();
     }
     catch (const exception& e) {
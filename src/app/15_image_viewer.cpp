@@ -3,7 +3,7 @@
 #include <glad/glad.h>
 #include "../format/Image.hpp"
 #include "../gl/Texture.hpp"
-#include "../util/filehandler.hpp"
+#include "../util/MappedFile.hpp"
 #include "../window/Window.hpp"
 
 using namespace std;
@@ -81,7 +81,7 @@ int main(int argc, const char* argv[])
 
         for (int i = 1; i < argc; i++)
         {
-            Image image(readFile(argv[i]));
+            Image image(mapFile(argv[i]));
             
             cout << "image: " << argv[i] << " (" << image.width << 'x' << image.height << 'x' << image.channels << ')' << endl;
 
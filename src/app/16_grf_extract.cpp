@@ -0,0 +1,175 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include "../format/Grf.hpp"
+#include "../util/InvalidResource.hpp"
+#include "../util/MemoryBudget.hpp"
+#include "../util/filehandler.hpp"
+#include "../util/ThreadPool.hpp"
+
+using namespace std;
+using namespace format;
+
+using Clock = chrono::steady_clock;
+
+/// Converts an archive path into a relative output path, or an empty one if it escapes the output directory.
+static filesystem::path outputPath(string_view filename)
+{
+    filesystem::path path;
+    size_t begin = 0;
+
+    while (begin <= filename.size())
+    {
+        size_t end = filename.find_first_of("/\\", begin);
+
+        if (end == string_view::npos)
+            end = filename.size();
+
+        const string_view part = filename.substr(begin, end - begin);
+
+        if (part == "..")
+            return {};
+
+        if (!part.empty() && part != ".")
+            path /= string(part);
+
+        begin = end + 1;
+    }
+
+    return path;
+}
+
+static double megabytesPerSecond(size_t bytes, double seconds)
+{
+    return seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0;
+}
+
+int main(int argc, const char* argv[])
+{
+    unsigned int thread_count = 0;
+    size_t max_in_flight_mb = 256;
+    bool verbose = false;
+    int arg = 1;
+
+    // Options
+    for (; arg < argc && argv[arg][0] == '-'; arg++)
+    {
+        if (argv[arg][1] == 'j')
+            thread_count = atoi(&argv[arg][2]);
+        else if (argv[arg][1] == 'm')
+            max_in_flight_mb = atoi(&argv[arg][2]);
+        else if (argv[arg][1] == 'v')
+            verbose = true;
+        else
+            break;
+    }
+
+    if (argc - arg < 1)
+    {
+        cout << "Usage: " << argv[0] << " [-j<threads>] [-m<megabytes>] [-v] <grf file> [<path>]" << endl;
+        cout << "Extracts every file from a grf archive into path (default: current directory)." << endl;
+        cout << "  -j<threads>    number of decompression threads (default: one per hardware thread)" << endl;
+        cout << "  -m<megabytes>  maximum decompressed data held in memory at once (default: 256)" << endl;
+        cout << "  -v             show each extracted entry and its throughput" << endl;
+        return 1;
+    }
+
+    const char* grf_fn = argv[arg];
+    const filesystem::path out_path = (argc - arg > 1) ? argv[arg + 1] : ".";
+
+    try {
+        Grf grf(grf_fn);
+        ThreadPool pool(thread_count);
+        MemoryBudget budget(max_in_flight_mb * 1024 * 1024);
+        mutex output_mutex;
+
+        size_t extracted_count = 0;
+        size_t extracted_bytes = 0;
+        size_t failed_count = 0;
+        double inflate_seconds = 0;
+
+        cout << "Extracting " << grf.entries().size() << " entries from '" << grf_fn << "' using " << pool.size() << " threads" << endl;
+
+        const Clock::time_point start = Clock::now();
+
+        for (const Grf::Entry& entry : grf.entries())
+        {
+            // Waiting here bounds the data queued and in flight
+            budget.acquire(entry.size);
+
+            pool.submit([&, entry] {
+                string error;
+                double entry_seconds = 0;
+
+                try {
+                    const filesystem::path path = outputPath(entry.filename);
+
+                    if (path.empty())
+                        throw InvalidResource("path escapes the output directory");
+
+                    const Clock::time_point entry_start = Clock::now();
+                    const Buffer buf = grf.read(entry);
+                    entry_seconds = chrono::duration<double>(Clock::now() - entry_start).count();
+
+                    const filesystem::path file_path = out_path / path;
+                    filesystem::create_directories(file_path.parent_path());
+
+                    // writeFile skips empty buffers, but empty entries still need their file
+                    if (buf.size())
+                        writeFile(file_path.string().c_str(), buf);
+                    else if (!ofstream(file_path, ofstream::binary))
+                        throw FileNotOpen(file_path.string());
+                }
+                catch (const exception& e) {
+                    error = e.what();
+                }
+
+                budget.release(entry.size);
+
+                lock_guard<mutex> lock(output_mutex);
+
+                if (!error.empty()) {
+                    failed_count++;
+                    cout << "Error extracting '" << entry.filename << "': " << error << endl;
+                    return;
+                }
+
+                extracted_count++;
+                extracted_bytes += entry.size;
+                inflate_seconds += entry_seconds;
+
+                if (verbose)
+                {
+                    cout << "  " << entry.filename << " (" << entry.size << " bytes, "
+                        << fixed << setprecision(1) << megabytesPerSecond(entry.size, entry_seconds) << " MB/s)" << endl;
+                }
+            });
+        }
+
+        pool.wait();
+
+        const double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+        cout << "Extracted " << extracted_count << " entries (" << extracted_bytes << " bytes) in "
+            << fixed << setprecision(2) << seconds << " s" << endl;
+        cout << "  throughput: " << setprecision(1) << megabytesPerSecond(extracted_bytes, seconds) << " MB/s, "
+            << (seconds > 0 ? extracted_count / seconds : 0) << " entries/s" << endl;
+        cout << "  inflate throughput per thread: " << megabytesPerSecond(extracted_bytes, inflate_seconds) << " MB/s" << endl;
+
+        if (failed_count) {
+            cout << "  failed: " << failed_count << endl;
+            return 1;
+        }
+    }
+    catch (const exception& e) {
+        cout << "Exception: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "../format/GrfWriter.hpp"
+#include "../util/ThreadPool.hpp"
+
+using namespace std;
+using namespace format;
+
+using Clock = chrono::steady_clock;
+
+/// Converts a path relative to the packed directory into an archive path.
+static string archivePath(const filesystem::path& relative_path)
+{
+    string path;
+
+    for (const filesystem::path& part : relative_path)
+    {
+        if (!path.empty())
+            path += '\\';
+
+        path += part.string();
+    }
+
+    return path;
+}
+
+int main(int argc, const char* argv[])
+{
+    unsigned int thread_count = 0;
+    size_t max_in_flight_mb = GrfWriter::default_max_in_flight / (1024 * 1024);
+    bool patch = false;
+    int arg = 1;
+
+    // Options
+    for (; arg < argc && argv[arg][0] == '-'; arg++)
+    {
+        if (argv[arg][1] == 'j')
+            thread_count = atoi(&argv[arg][2]);
+        else if (argv[arg][1] == 'm')
+            max_in_flight_mb = atoi(&argv[arg][2]);
+        else if (argv[arg][1] == 'p')
+            patch = true;
+        else
+            break;
+    }
+
+    if (argc - arg < 2)
+    {
+        cout << "Usage: " << argv[0] << " [-j<threads>] [-m<megabytes>] [-p] <grf file> <directory>" << endl;
+        cout << "Adds every file under directory to a grf archive, creating it if it doesn't exist." << endl;
+        cout << "  -j<threads>    number of compression threads (default: one per hardware thread)" << endl;
+        cout << "  -m<megabytes>  maximum file data read and compressed at once (default: "
+            << GrfWriter::default_max_in_flight / (1024 * 1024) << ')' << endl;
+        cout << "  -p             patch the archive in place, appending only changed files" << endl;
+        return 1;
+    }
+
+    const char* grf_fn = argv[arg];
+    const filesystem::path dir_path = argv[arg + 1];
+
+    try {
+        const bool exists = filesystem::exists(grf_fn);
+        auto writer = exists ? make_unique<GrfWriter>(grf_fn) : make_unique<GrfWriter>();
+
+        ThreadPool pool(thread_count);
+        const size_t max_in_flight = max_in_flight_mb * 1024 * 1024;
+        size_t file_count = 0;
+
+        for (const filesystem::directory_entry& entry : filesystem::recursive_directory_iterator(dir_path))
+        {
+            if (!entry.is_regular_file())
+                continue;
+
+            // Read when written, so only the files being compressed are held in memory
+            writer->addFile(archivePath(filesystem::relative(entry.path(), dir_path)), entry.path().string());
+            file_count++;
+        }
+
+        cout << (patch && exists ? "Patching '" : "Writing '") << grf_fn << "' with " << file_count
+            << " files using " << pool.size() << " threads" << endl;
+
+        const Clock::time_point start = Clock::now();
+        GrfWriter::Stats stats;
+
+        if (patch && exists) {
+            stats = writer->patch(pool, max_in_flight);
+        }
+        else {
+            // Write next to the archive, replacing it only once complete
+            const string tmp_fn = string(grf_fn) + ".tmp";
+            stats = writer->write(tmp_fn.c_str(), pool, max_in_flight);
+            writer.reset();
+            filesystem::rename(tmp_fn, grf_fn);
+        }
+
+        const double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+        cout << "Done in " << fixed << setprecision(2) << seconds << " s" << endl;
+        cout << "  entries: " << stats.entry_count << endl;
+        cout << "  compressed: " << stats.compressed_count << endl;
+        cout << "  reused: " << stats.reused_count << endl;
+        cout << "  bytes written: " << stats.written_bytes << endl;
+        cout << "  archive size: " << stats.archive_size << endl;
+    }
+    catch (const exception& e) {
+        cout << "Exception: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
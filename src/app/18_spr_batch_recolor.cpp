@@ -0,0 +1,119 @@
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../format/Image.hpp"
+#include "../format/Pal.hpp"
+#include "../format/Spr.hpp"
+#include "../format/SprAtlas.hpp"
+#include "../util/filehandler.hpp"
+#include "../util/MappedFile.hpp"
+#include "../util/ThreadPool.hpp"
+
+using namespace std;
+using namespace format;
+
+using Clock = chrono::steady_clock;
+
+int main(int argc, const char* argv[])
+{
+    unsigned int thread_count = 0;
+    unsigned int max_width = 2048;
+    filesystem::path out_path = ".";
+    PalLut::Alpha alpha = PalLut::KeyedFirstColor;
+    int arg = 1;
+
+    // Options
+    for (; arg < argc && argv[arg][0] == '-'; arg++)
+    {
+        if (argv[arg][1] == 'j')
+            thread_count = atoi(&argv[arg][2]);
+        else if (argv[arg][1] == 'w')
+            max_width = atoi(&argv[arg][2]);
+        else if (argv[arg][1] == 'o')
+            out_path = &argv[arg][2];
+        else if (argv[arg][1] == 'a')
+            alpha = PalLut::PalAlpha;
+        else
+            break;
+    }
+
+    if (argc - arg < 2)
+    {
+        cout << "Usage: " << argv[0] << " [-j<threads>] [-w<max width>] [-o<path>] [-a] <spr file> <pal file>..." << endl;
+        cout << "Renders the spr's palette images into one bmp atlas per palette, named <spr>_<pal>.bmp." << endl;
+        cout << "  -j<threads>    number of rendering threads (default: one per hardware thread)" << endl;
+        cout << "  -w<max width>  maximum atlas width in pixels (default: 2048)" << endl;
+        cout << "  -o<path>       output directory (default: current directory)" << endl;
+        cout << "  -a             use the palettes' alpha instead of keying out the first color" << endl;
+        return 1;
+    }
+
+    const char* spr_fn = argv[arg++];
+
+    try {
+        const Spr spr(mapFile(spr_fn));
+        const string spr_name = filesystem::path(spr_fn).stem().string();
+
+        vector<Pal> pals;
+        vector<string> pal_names;
+
+        for (; arg < argc; arg++)
+        {
+            pals.emplace_back(mapFile(argv[arg]));
+            pal_names.push_back(filesystem::path(argv[arg]).stem().string());
+        }
+
+        const SprAtlas atlas(spr, max_width);
+        ThreadPool pool(thread_count);
+        mutex output_mutex;
+        size_t failed_count = 0;
+
+        cout << "Rendering " << spr.palette_images.size() << " images of '" << spr_fn << "' into "
+            << atlas.width() << 'x' << atlas.height() << " atlases with " << pals.size() << " palettes using "
+            << pool.size() << " threads" << endl;
+
+        const Clock::time_point start = Clock::now();
+
+        atlas.renderEach(pals, alpha, pool, [&](size_t i, const vector<uint8_t>& pixels) {
+            const string bmp_fn = (out_path / (spr_name + '_' + pal_names[i] + ".bmp")).string();
+            string error;
+
+            try {
+                Buffer buf;
+                Image::saveAsBmp(buf, atlas.width(), atlas.height(), 4, pixels.data());
+                writeFile(bmp_fn.c_str(), buf);
+            }
+            catch (const exception& e) {
+                error = e.what();
+            }
+
+            lock_guard<mutex> lock(output_mutex);
+
+            if (!error.empty()) {
+                failed_count++;
+                cout << "Error saving '" << bmp_fn << "': " << error << endl;
+                return;
+            }
+
+            cout << "Exported bmp: " << bmp_fn << endl;
+        });
+
+        const double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+        cout << "Rendered " << pals.size() - failed_count << " atlases in " << fixed << setprecision(2) << seconds << " s" << endl;
+
+        if (failed_count)
+            return 1;
+    }
+    catch (const exception& e) {
+        cout << "Exception: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
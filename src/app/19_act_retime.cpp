@@ -0,0 +1,97 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include "../format/Act.hpp"
+#include "../util/filehandler.hpp"
+#include "../util/MappedFile.hpp"
+#include "../util/ThreadPool.hpp"
+
+using namespace std;
+using namespace format;
+
+using Clock = chrono::steady_clock;
+
+int main(int argc, const char* argv[])
+{
+    unsigned int thread_count = 0;
+    int arg = 1;
+
+    // Options
+    for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] == 'j'; arg++)
+        thread_count = atoi(&argv[arg][2]);
+
+    if (argc - arg < 2)
+    {
+        cout << "Usage: " << argv[0] << " [-j<threads>] <factor> <act file>..." << endl;
+        cout << "Multiplies every animation delay of the act files by factor, rewriting them in place." << endl;
+        cout << "  -j<threads>  number of threads (default: one per hardware thread)" << endl;
+        return 1;
+    }
+
+    const float factor = strtof(argv[arg++], nullptr);
+
+    if (factor <= 0) {
+        cout << "Factor must be positive" << endl;
+        return 1;
+    }
+
+    ThreadPool pool(thread_count);
+    mutex output_mutex;
+    atomic<size_t> failed_count{ 0 };
+
+    const Clock::time_point start = Clock::now();
+
+    for (int i = arg; i < argc; i++)
+    {
+        pool.submit([&, filename = argv[i]] {
+            try {
+                Act act;
+
+                // Unmap before rewriting the file
+                {
+                    MappedFile file = mapFile(filename);
+                    act.load(file);
+                }
+
+                for (Act::Animation& anim : act.animations)
+                    anim.delay *= factor;
+
+                Buffer buf;
+                act.save(buf);
+
+                // Write next to the source, replacing it only once complete
+                const string tmp_fn = string(filename) + ".tmp";
+                writeFile(tmp_fn.c_str(), buf);
+
+                if (filesystem::file_size(tmp_fn) != buf.size()) {
+                    filesystem::remove(tmp_fn);
+                    throw runtime_error("could not write file '" + tmp_fn + "'");
+                }
+
+                filesystem::rename(tmp_fn, filename);
+            }
+            catch (const exception& e) {
+                failed_count++;
+
+                lock_guard<mutex> lock(output_mutex);
+                cout << "Error retiming '" << filename << "': " << e.what() << endl;
+            }
+        });
+    }
+
+    pool.wait();
+
+    const double seconds = chrono::duration<double>(Clock::now() - start).count();
+    const size_t file_count = argc - arg;
+
+    cout << "Retimed " << file_count - failed_count << '/' << file_count << " act files in "
+        << fixed << setprecision(2) << seconds << " s" << endl;
+
+    return failed_count ? 1 : 0;
+}
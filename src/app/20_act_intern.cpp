@@ -0,0 +1,47 @@
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "../format/ActInterner.hpp"
+#include "../util/MappedFile.hpp"
+
+using namespace std;
+using namespace format;
+
+int main(int argc, const char* argv[])
+{
+    if (argc < 2) {
+        cout << "Usage: " << argv[0] << " <act file>..." << endl;
+        cout << "Loads act files sharing identical frames and animations, and reports the memory saved." << endl;
+        return 1;
+    }
+
+    ActInterner interner;
+    vector<ActInterner::InternedAct> acts;
+    acts.reserve(argc - 1);
+
+    for (int i = 1; i < argc; i++)
+    {
+        try {
+            acts.push_back(interner.load(mapFile(argv[i])));
+        }
+        catch (const exception& e) {
+            cout << "Error loading '" << argv[i] << "': " << e.what() << endl;
+        }
+    }
+
+    const ActInterner::Stats stats = interner.stats();
+
+    cout << "acts: " << acts.size() << endl;
+    cout << "animations: " << stats.animation_refs << " (" << stats.unique_animations << " unique)" << endl;
+    cout << "frames: " << stats.frame_refs << " (" << stats.unique_frames << " unique)" << endl;
+    cout << "plain memory: " << stats.plain_bytes / 1024 << " KiB" << endl;
+    cout << "interned memory: " << stats.interned_bytes / 1024 << " KiB" << endl;
+    cout << "saved: " << stats.savedBytes() / 1024 << " KiB";
+
+    if (stats.plain_bytes)
+        cout << " (" << fixed << setprecision(1) << 100.0 * stats.savedBytes() / stats.plain_bytes << "%)";
+
+    cout << endl;
+
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include <iostream>
+#include <string>
+#include "../format/Str.hpp"
+#include "../format/StrCache.hpp"
+#include "../util/filehandler.hpp"
+#include "../util/MappedFile.hpp"
+
+using namespace std;
+using namespace format;
+
+int main(int argc, const char* argv[])
+{
+    if (argc < 2) {
+        cout << "Usage: " << argv[0] << " <str file>..." << endl;
+        cout << "Writes a cache of each str file next to it, as <str file>c." << endl;
+        return 1;
+    }
+
+    size_t str_bytes = 0;
+    size_t cache_bytes = 0;
+    int cached_count = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        try {
+            MappedFile file = mapFile(argv[i]);
+            const Str str(file);
+
+            Buffer buf;
+            StrCache::save(str, buf);
+
+            const string cache_filename = string(argv[i]) + 'c';
+            writeFile(cache_filename.c_str(), buf);
+
+            str_bytes += file.size();
+            cache_bytes += buf.size();
+            cached_count++;
+        }
+        catch (const exception& e) {
+            cout << "Error caching '" << argv[i] << "': " << e.what() << endl;
+        }
+    }
+
+    cout << "cached " << cached_count << " of " << argc - 1 << " str files" << endl;
+    cout << "str files: " << str_bytes / 1024 << " KiB" << endl;
+    cout << "caches: " << cache_bytes / 1024 << " KiB" << endl;
+
+    return 0;
+}
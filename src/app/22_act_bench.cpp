@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../format/Act.hpp"
+#include "../format/FlatAct.hpp"
+#include "../util/filehandler.hpp"
+
+using namespace std;
+using namespace format;
+
+using Clock = chrono::steady_clock;
+
+static double megabytesPerSecond(size_t bytes, double seconds)
+{
+    return seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0;
+}
+
+/// Times loading every file with Parser, returning the fastest and median pass in seconds.
+template <typename Parser>
+static pair<double, double> timeLoads(const vector<Buffer>& files, int iterations)
+{
+    vector<double> passes;
+    passes.reserve(iterations);
+
+    for (int i = 0; i < iterations; i++)
+    {
+        const Clock::time_point start = Clock::now();
+
+        for (const Buffer& file : files)
+        {
+            Parser parser;
+            parser.load(BufferView(file.data(), file.size()));
+        }
+
+        passes.push_back(chrono::duration<double>(Clock::now() - start).count());
+    }
+
+    sort(passes.begin(), passes.end());
+    return { passes.front(), passes[passes.size() / 2] };
+}
+
+template <typename Parser>
+static void report(const char* name, const vector<Buffer>& files, size_t total_bytes, int iterations)
+{
+    const auto [best, median] = timeLoads<Parser>(files, iterations);
+
+    cout << setw(8) << left << name << right
+        << fixed << setprecision(2)
+        << " best " << setw(9) << best * 1000 << " ms"
+        << "  median " << setw(9) << median * 1000 << " ms"
+        << "  (" << setprecision(1) << megabytesPerSecond(total_bytes, best) << " MB/s)" << endl;
+}
+
+int main(int argc, const char* argv[])
+{
+    int iterations = 20;
+    int arg = 1;
+
+    // Options
+    for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] == 'n'; arg++)
+        iterations = atoi(&argv[arg][2]);
+
+    if (argc - arg != 1 || iterations <= 0)
+    {
+        cout << "Usage: " << argv[0] << " [-n<iterations>] <directory>" << endl;
+        cout << "Times loading every act file under directory with Act and FlatAct." << endl;
+        cout << "  -n<iterations>  number of passes over the files (default: 20)" << endl;
+        return 1;
+    }
+
+    // Read everything up front so only parsing is timed
+    vector<Buffer> files;
+    size_t total_bytes = 0;
+
+    for (const auto& dir_entry : filesystem::recursive_directory_iterator(argv[arg]))
+    {
+        if (!dir_entry.is_regular_file())
+            continue;
+
+        string extension = dir_entry.path().extension().string();
+        transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return tolower(c); });
+
+        if (extension != ".act")
+            continue;
+
+        const string filename = dir_entry.path().string();
+
+        try {
+            Buffer buf = readFile(filename.c_str());
+
+            // Skip files that don't load, so errors don't skew the timings
+            Act act(BufferView(buf.data(), buf.size()));
+
+            total_bytes += buf.size();
+            files.push_back(move(buf));
+        }
+        catch (const exception& e) {
+            cout << "Skipping '" << filename << "': " << e.what() << endl;
+        }
+    }
+
+    if (files.empty()) {
+        cout << "No act files found" << endl;
+        return 1;
+    }
+
+    cout << files.size() << " act files, " << total_bytes / 1024 << " KiB, "
+        << iterations << " passes" << endl;
+
+    report<Act>("Act", files, total_bytes, iterations);
+    report<FlatAct>("FlatAct", files, total_bytes, iterations);
+
+    return 0;
+}
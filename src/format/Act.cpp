@@ -1,109 +1,142 @@
 #include "Act.hpp"
 
-#include <cstring>
-#include <cmath>
+#include "ActRecords.hpp"
 #include "../util/InvalidResource.hpp"
 
 using namespace std;
 
 namespace format {
 
-void Act::load(const Buffer& buf)
-try {
-    const char act_magic[] = {'A', 'C'};
-    char magic[sizeof(act_magic)];
+/// Reads everything after the header, with the record layout of a version.
+template <int HexVersion>
+static void loadBody(const BufferView& buf, Act& act)
+{
+    using Records = act_records::Records<HexVersion>;
+
+    // Read animations
+    for (Act::Animation& anim : act.animations)
+    {
+        // Frame count, checking every frame could be present before allocating them
+        const uint32_t frame_count = buf.readUint32();
+        buf.require(frame_count * Records::min_frame_size);
+        anim.frames.resize(frame_count);
 
-    buf.read(magic, sizeof(act_magic));
+        // Read frames
+        for (Act::Frame& frame : anim.frames)
+        {
+            // Unnused 32 bytes
+            buf.read(frame.reserved.data(), frame.reserved.size());
 
-    // Check magic
-    if (strncmp(magic, act_magic, sizeof(act_magic)) != 0)
-        throw InvalidResource("act: invalid magic, expected 'AC'");
+            // Images, checking the whole image array is present before reading it
+            const uint32_t image_count = buf.readUint32();
+            buf.require(image_count * Records::image_size);
+            frame.images.resize(image_count);
+            Records::readImages(buf, frame.images.data(), image_count);
 
-    const int hex_version = buf.readUint16();
-    version.major = (hex_version >> 8) & 0xFF;
-    version.minor = hex_version & 0xFF;
+            // Sound index
+            frame.sound_index = buf.readUint32();
 
-    // Check version
-    switch (hex_version)
-    {
-        case 0x200:
-		case 0x201:
-		case 0x202:
-		case 0x203:
-		case 0x204:
-		case 0x205:
-            break; // supported
-        default:
-            throw InvalidResource("act: unsupported version '" + to_string(version.major) + '.' + to_string(version.minor) + "'");
+            // Anchors
+            if constexpr (Records::has_anchors)
+            {
+                const uint32_t anchor_count = buf.readUint32();
+                buf.require(anchor_count * Records::anchor_size);
+                frame.anchors.resize(anchor_count);
+                Records::readAnchors(buf, frame.anchors.data(), anchor_count);
+            }
+        }
     }
 
-    // Animation count
-    animations.resize(buf.readUint16());
-    
-    // Unnused 10 bytes
-    buf.skip(10);
+    if constexpr (Records::has_sounds)
+        act_records::readSounds(buf, act.sounds);
 
-    // Read animations
-    for (Animation& anim : animations)
+    if constexpr (Records::has_delays)
+        act_records::readDelays(buf, act.animations);
+}
+
+void Act::load(const BufferView& buf)
+try {
+    size_t animation_count;
+    const int hex_version = act_records::readHeader(buf, version, reserved, animation_count);
+
+    animations.resize(animation_count);
+
+    act_records::dispatchVersion(hex_version, [&](auto hex) {
+        loadBody<decltype(hex)::value>(buf, *this);
+    });
+}
+catch (const out_of_range&) {
+    throw InvalidResource("act: missing data");
+}
+
+void Act::save(Buffer& buf) const
+{
+    const int hex_version = (version.major << 8) | version.minor;
+
+    if (hex_version < 0x200 || hex_version > 0x205)
+        throw InvalidResource("act: unsupported version '" + to_string(version.major) + '.' + to_string(version.minor) + "'");
+
+    if (animations.size() > 0xFFFF)
+        throw InvalidResource("act: too many animations");
+
+    // Make room for everything at once, so the writes below never reallocate
+    const size_t size = serializedSize();
+
+    if (size > buf.remaining())
+        buf.grow(size - buf.remaining());
+
+    const char act_magic[] = {'A', 'C'};
+    buf.write(act_magic, sizeof(act_magic));
+
+    buf.setUint16(static_cast<uint16_t>(hex_version));
+    buf.setUint16(static_cast<uint16_t>(animations.size()));
+    buf.write(reserved.data(), reserved.size());
+
+    for (const Animation& anim : animations)
     {
-        // Frame count
-        anim.frames.resize(buf.readUint32());
+        buf.setUint32(static_cast<uint32_t>(anim.frames.size()));
 
-        // Read frames
-        for (Frame& frame : anim.frames)
+        for (const Frame& frame : anim.frames)
         {
-            // Unnused 32 bytes
-            buf.skip(32);
+            buf.write(frame.reserved.data(), frame.reserved.size());
 
-            // Images count
-            frame.images.resize(buf.readUint32());
+            buf.setUint32(static_cast<uint32_t>(frame.images.size()));
 
-            // Read images
-            for (Image& image : frame.images)
+            for (const Image& image : frame.images)
             {
-                image.x = buf.readUint32();
-                image.y = buf.readUint32();
-                image.index = buf.readUint32();
-                image.mirror = (buf.readUint32() != 0);
-                
-                if (hex_version >= 0x200)
-                {
-                    image.color = Color(buf.readUint32());
+                const Color& c = image.color;
 
-                    if (hex_version >= 0x204) {
-                        image.scale_x = round(buf.readFloat());
-                        image.scale_y = round(buf.readFloat());
-                    }
-                    else {
-                        image.scale_x = image.scale_y = round(buf.readFloat());
-                    }
+                buf.setInt32(image.x);
+                buf.setInt32(image.y);
+                buf.setInt32(image.index);
+                buf.setUint32(image.mirror ? 1 : 0);
+                buf.setUint32((c.r << 24) | (c.g << 16) | (c.b << 8) | c.a);
+                buf.setFloat(image.scale_x);
 
-                    image.rotation = buf.readUint32();
-                    image.is_rgba = (buf.readUint32() == 1); // 0 - palette, 1 - rgba
+                if (hex_version >= 0x204)
+                    buf.setFloat(image.scale_y);
 
-                    // dontjump?
+                buf.setInt32(image.rotation);
+                buf.setUint32(image.is_rgba ? 1 : 0);
 
-                    if (hex_version >= 0x205) {
-                        image.width = buf.readUint32();
-                        image.height = buf.readUint32();
-                    }
+                if (hex_version >= 0x205) {
+                    buf.setInt32(image.width);
+                    buf.setInt32(image.height);
                 }
             }
 
-            // Sound index
-            if (hex_version >= 0x200)
-                frame.sound_index = buf.readUint32();
+            buf.setInt32(frame.sound_index);
 
-            // Anchors
-            if (hex_version >= 0x203) {
-                frame.anchors.resize(buf.readUint32());
+            if (hex_version >= 0x203)
+            {
+                buf.setUint32(static_cast<uint32_t>(frame.anchors.size()));
 
-                for (Anchor& anchor : frame.anchors)
+                for (const Anchor& anchor : frame.anchors)
                 {
-                    buf.skip(4); // unnused
-                    anchor.x = buf.readUint32();
-                    anchor.y = buf.readUint32();
-                    anchor.attribute = buf.readUint32();
+                    buf.setUint32(anchor.reserved);
+                    buf.setInt32(anchor.x);
+                    buf.setInt32(anchor.y);
+                    buf.setInt32(anchor.attribute);
                 }
             }
         }
@@ -111,31 +144,51 @@ try {
 
     if (hex_version >= 0x201)
     {
-        // Sound count
-        sounds.resize(buf.readUint32());
+        buf.setUint32(static_cast<uint32_t>(sounds.size()));
 
-        // Read sound paths
-        for (Sound& sound : sounds)
-        {
-            buf.read(sound.filename.data(), sound.filename.size());
-            sound.filename[39] = '\0';
-        }
+        buf.writeArray(sounds.data(), sounds.size());
     }
 
-    // Read delays
     if (hex_version >= 0x202)
     {
-        for (Animation& anim : animations)
-            anim.delay = round(buf.readFloat());
+        for (const Animation& anim : animations)
+            buf.setFloat(anim.delay);
     }
 }
-catch (const out_of_range&) {
-    throw InvalidResource("act: missing data");
-}
 
-void Act::save(Buffer& buf) const
+size_t Act::serializedSize() const
 {
+    const int hex_version = (version.major << 8) | version.minor;
+    size_t image_size = 0;
+    size_t anchor_size = 0;
+
+    act_records::dispatchVersion(hex_version, [&](auto hex) {
+        using Records = act_records::Records<decltype(hex)::value>;
+
+        image_size = Records::image_size;
+        anchor_size = (Records::has_anchors ? Records::anchor_size : 0);
+    });
+
+    // Magic, version, animation count and reserved bytes
+    size_t size = 16;
+
+    for (const Animation& anim : animations)
+    {
+        // Frame count
+        size += 4;
+
+        // Reserved bytes, image count, sound index and anchor count
+        for (const Frame& frame : anim.frames)
+            size += 40 + (hex_version >= 0x203 ? 4 : 0) + frame.images.size() * image_size + frame.anchors.size() * anchor_size;
+    }
+
+    if (hex_version >= 0x201)
+        size += 4 + sounds.size() * sizeof(Sound);
+
+    if (hex_version >= 0x202)
+        size += animations.size() * 4;
 
+    return size;
 }
 
 } // namespace format
\ No newline at end of file
@@ -27,10 +27,12 @@ struct Act {
         int x;
         int y;
         int attribute;
+        uint32_t reserved = 0;        // unused, kept so saving is byte-exact
     };
 
     /// A frame is a mix of images, anchors, and a sound.
     struct Frame {
+        std::array<uint8_t, 32> reserved{}; // unused ranges, kept so saving is byte-exact
         int sound_index = -1;
         std::vector<Image> images;
         std::vector<Anchor> anchors;
@@ -50,19 +52,27 @@ struct Act {
     explicit Act() = default;
     
     /// Construct and loads from memory buffer.
-    explicit Act(const Buffer& buf) { load(buf); }
+    explicit Act(const BufferView& buf) { load(buf); }
 
     /**
      * Loads from memory buffer.
      *
      * @throws InvalidResource on failure.
      */
-    void load(const Buffer& buf);
+    void load(const BufferView& buf);
 
-    /// Saves to memory buffer.
+    /**
+     * Saves to memory buffer, allocating it once.
+     *
+     * @throws InvalidResource if version is unsupported or counts don't fit the format.
+     */
     void save(Buffer& buf) const;
 
+    /// Number of bytes written by save().
+    size_t serializedSize() const;
+
     struct { uint8_t major, minor; } version;
+    std::array<uint8_t, 10> reserved{}; // unused, kept so saving is byte-exact
     std::vector<Animation> animations;
     std::vector<Sound> sounds;
 };
@@ -0,0 +1,243 @@
+#include "ActInterner.hpp"
+
+#include <cstring>
+
+using namespace std;
+
+namespace format {
+
+// Estimated bookkeeping of a pooled element: shared_ptr control block plus hash map node
+constexpr size_t pooled_overhead = 2 * sizeof(long) + sizeof(void*) + sizeof(size_t) + sizeof(shared_ptr<void>);
+
+/// Mixes a 32-bit value into an FNV-1a style hash.
+static void mix(size_t& hash, uint32_t value) noexcept
+{
+    hash = (hash ^ value) * static_cast<size_t>(0x100000001b3ULL);
+}
+
+static uint32_t floatBits(float value) noexcept
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static size_t hashFrame(const Act::Frame& frame) noexcept
+{
+    size_t hash = static_cast<size_t>(0xcbf29ce484222325ULL);
+
+    for (uint8_t byte : frame.reserved)
+        mix(hash, byte);
+
+    mix(hash, frame.sound_index);
+    mix(hash, static_cast<uint32_t>(frame.images.size()));
+
+    for (const Act::Image& image : frame.images)
+    {
+        mix(hash, image.x);
+        mix(hash, image.y);
+        mix(hash, image.width);
+        mix(hash, image.height);
+        mix(hash, image.rotation);
+        mix(hash, floatBits(image.scale_x));
+        mix(hash, floatBits(image.scale_y));
+        mix(hash, (image.mirror ? 1 : 0) | (image.is_rgba ? 2 : 0));
+        mix(hash, image.index);
+        mix(hash, (image.color.r << 24) | (image.color.g << 16) | (image.color.b << 8) | image.color.a);
+    }
+
+    for (const Act::Anchor& anchor : frame.anchors)
+    {
+        mix(hash, anchor.x);
+        mix(hash, anchor.y);
+        mix(hash, anchor.attribute);
+        mix(hash, anchor.reserved);
+    }
+
+    return hash;
+}
+
+/// Whether two images are the same, comparing floats bitwise so interning never alters values.
+static bool sameImage(const Act::Image& a, const Act::Image& b) noexcept
+{
+    return a.x == b.x && a.y == b.y
+        && a.width == b.width && a.height == b.height
+        && a.rotation == b.rotation
+        && floatBits(a.scale_x) == floatBits(b.scale_x)
+        && floatBits(a.scale_y) == floatBits(b.scale_y)
+        && a.mirror == b.mirror && a.is_rgba == b.is_rgba
+        && a.index == b.index
+        && memcmp(&a.color, &b.color, sizeof(Color)) == 0;
+}
+
+static bool sameAnchor(const Act::Anchor& a, const Act::Anchor& b) noexcept
+{
+    return a.x == b.x && a.y == b.y && a.attribute == b.attribute && a.reserved == b.reserved;
+}
+
+static bool sameFrame(const Act::Frame& a, const Act::Frame& b) noexcept
+{
+    if (a.sound_index != b.sound_index || a.reserved != b.reserved)
+        return false;
+
+    if (a.images.size() != b.images.size() || a.anchors.size() != b.anchors.size())
+        return false;
+
+    for (size_t i = 0; i < a.images.size(); i++)
+    {
+        if (!sameImage(a.images[i], b.images[i]))
+            return false;
+    }
+
+    for (size_t i = 0; i < a.anchors.size(); i++)
+    {
+        if (!sameAnchor(a.anchors[i], b.anchors[i]))
+            return false;
+    }
+
+    return true;
+}
+
+/// Animations refer to interned frames, so frames are told apart by address.
+static size_t hashAnimation(const ActInterner::Animation& anim) noexcept
+{
+    size_t hash = static_cast<size_t>(0xcbf29ce484222325ULL);
+    mix(hash, floatBits(anim.delay));
+
+    for (const ActInterner::FramePtr& frame : anim.frames)
+        hash = (hash ^ reinterpret_cast<uintptr_t>(frame.get())) * static_cast<size_t>(0x100000001b3ULL);
+
+    return hash;
+}
+
+static bool sameAnimation(const ActInterner::Animation& a, const ActInterner::Animation& b) noexcept
+{
+    return floatBits(a.delay) == floatBits(b.delay) && a.frames == b.frames;
+}
+
+/// Heap memory of a frame, besides the frame itself.
+static size_t frameHeapBytes(const Act::Frame& frame) noexcept
+{
+    return frame.images.capacity() * sizeof(Act::Image) + frame.anchors.capacity() * sizeof(Act::Anchor);
+}
+
+Act ActInterner::InternedAct::toAct() const
+{
+    Act act;
+    act.version = version;
+    act.reserved = reserved;
+    act.sounds = sounds;
+    act.animations.resize(animations.size());
+
+    for (size_t i = 0; i < animations.size(); i++)
+    {
+        act.animations[i].delay = animations[i]->delay;
+        act.animations[i].frames.reserve(animations[i]->frames.size());
+
+        for (const FramePtr& frame : animations[i]->frames)
+            act.animations[i].frames.push_back(*frame);
+    }
+
+    return act;
+}
+
+ActInterner::InternedAct ActInterner::intern(const Act& act)
+{
+    InternedAct interned;
+    interned.version = act.version;
+    interned.reserved = act.reserved;
+    interned.sounds = act.sounds;
+    interned.animations.reserve(act.animations.size());
+
+    for (const Act::Animation& act_anim : act.animations)
+    {
+        Animation anim;
+        anim.delay = act_anim.delay;
+        anim.frames.reserve(act_anim.frames.size());
+
+        for (const Act::Frame& frame : act_anim.frames)
+            anim.frames.push_back(internFrame(frame));
+
+        interned.animations.push_back(internAnimation(std::move(anim)));
+    }
+
+    return interned;
+}
+
+ActInterner::FramePtr ActInterner::internFrame(const Act::Frame& frame)
+{
+    const size_t hash = hashFrame(frame);
+    const auto range = frames_.equal_range(hash);
+
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (sameFrame(*it->second, frame))
+            return it->second;
+    }
+
+    // Copy without the spare capacity of the source
+    auto stored = make_shared<Act::Frame>();
+    stored->reserved = frame.reserved;
+    stored->sound_index = frame.sound_index;
+    stored->images.assign(frame.images.begin(), frame.images.end());
+    stored->anchors.assign(frame.anchors.begin(), frame.anchors.end());
+
+    return frames_.emplace(hash, std::move(stored))->second;
+}
+
+ActInterner::AnimationPtr ActInterner::internAnimation(Animation anim)
+{
+    const size_t hash = hashAnimation(anim);
+    const auto range = animations_.equal_range(hash);
+
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (sameAnimation(*it->second, anim))
+            return it->second;
+    }
+
+    return animations_.emplace(hash, make_shared<const Animation>(std::move(anim)))->second;
+}
+
+void ActInterner::purge()
+{
+    // Animations go first, since they hold frames
+    for (auto it = animations_.begin(); it != animations_.end(); )
+        it = (it->second.use_count() == 1 ? animations_.erase(it) : next(it));
+
+    for (auto it = frames_.begin(); it != frames_.end(); )
+        it = (it->second.use_count() == 1 ? frames_.erase(it) : next(it));
+}
+
+ActInterner::Stats ActInterner::stats() const
+{
+    Stats stats;
+
+    stats.unique_frames = frames_.size();
+    stats.unique_animations = animations_.size();
+
+    for (const auto& entry : frames_)
+        stats.interned_bytes += sizeof(Act::Frame) + frameHeapBytes(*entry.second) + pooled_overhead;
+
+    for (const auto& entry : animations_)
+    {
+        const Animation& anim = *entry.second;
+
+        // Every other owner is an interned act
+        const size_t refs = entry.second.use_count() - 1;
+        size_t plain_bytes = sizeof(Act::Animation) + anim.frames.size() * sizeof(Act::Frame);
+
+        for (const FramePtr& frame : anim.frames)
+            plain_bytes += frameHeapBytes(*frame);
+
+        stats.animation_refs += refs;
+        stats.frame_refs += refs * anim.frames.size();
+        stats.plain_bytes += refs * plain_bytes;
+        stats.interned_bytes += refs * sizeof(AnimationPtr)
+            + sizeof(Animation) + anim.frames.capacity() * sizeof(FramePtr) + pooled_overhead;
+    }
+
+    return stats;
+}
+
+} // namespace format
@@ -0,0 +1,84 @@
+#ifndef ROTOOLS_FORMAT_ACTINTERNER_HPP
+#define ROTOOLS_FORMAT_ACTINTERNER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Act.hpp"
+
+namespace format {
+
+/**
+ * Loads acts storing each distinct frame and animation once.
+ *
+ * Acts of many files, such as headgear or palette variants of a job, share
+ * identical animations. Interned acts hold their animations, and animations
+ * their frames, through shared pointers into the interner's pools, so
+ * duplicates across files cost a pointer. Interned acts keep their
+ * animations alive after the interner is gone. Not thread-safe.
+ */
+class ActInterner final {
+public:
+    using FramePtr = std::shared_ptr<const Act::Frame>;
+
+    struct Animation {
+        float delay = 4.f;
+        std::vector<FramePtr> frames;
+    };
+
+    using AnimationPtr = std::shared_ptr<const Animation>;
+
+    /// Act whose animations are shared with other acts of the same interner.
+    struct InternedAct {
+        /// Copies into an Act.
+        Act toAct() const;
+
+        decltype(Act::version) version;
+        std::array<uint8_t, 10> reserved{};
+        std::vector<AnimationPtr> animations;
+        std::vector<Act::Sound> sounds;
+    };
+
+    /// Memory taken by the acts currently alive, estimated from element and container sizes.
+    struct Stats {
+        size_t unique_frames = 0;     // frames stored
+        size_t frame_refs = 0;        // frames of every live act, duplicates included
+        size_t unique_animations = 0; // animations stored
+        size_t animation_refs = 0;    // animations of every live act, duplicates included
+        size_t plain_bytes = 0;       // memory live acts would take as separate Act objects
+        size_t interned_bytes = 0;    // memory the pools take
+
+        size_t savedBytes() const noexcept { return plain_bytes > interned_bytes ? plain_bytes - interned_bytes : 0; }
+    };
+
+    /// Interns the animations of an act.
+    InternedAct intern(const Act& act);
+
+    /**
+     * Loads an act from memory buffer and interns it.
+     *
+     * @throws InvalidResource on failure.
+     */
+    InternedAct load(const BufferView& buf) { return intern(Act(buf)); }
+
+    /// Drops frames and animations no longer used by any interned act.
+    void purge();
+
+    /// Computes the memory statistics of the acts alive, walking the pools.
+    Stats stats() const;
+
+private:
+    FramePtr internFrame(const Act::Frame& frame);
+    AnimationPtr internAnimation(Animation anim);
+
+    // Keyed by content hash; equal hashes are compared in full
+    std::unordered_multimap<size_t, FramePtr> frames_;
+    std::unordered_multimap<size_t, AnimationPtr> animations_;
+};
+
+} // namespace format
+
+#endif // ROTOOLS_FORMAT_ACTINTERNER_HPP
@@ -0,0 +1,186 @@
+#ifndef ROTOOLS_FORMAT_ACTRECORDS_HPP
+#define ROTOOLS_FORMAT_ACTRECORDS_HPP
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Act.hpp"
+#include "../util/BufferView.hpp"
+#include "../util/InvalidResource.hpp"
+
+// Act record readers shared by Act and FlatAct. Internal to the format library.
+
+namespace format {
+namespace act_records {
+
+/**
+ * Layout of the records of a version, so parsers instantiated per version
+ * read fixed-size records without checking the version for every field.
+ */
+template <int HexVersion>
+struct Records {
+    static constexpr bool has_sounds = (HexVersion >= 0x201);
+    static constexpr bool has_delays = (HexVersion >= 0x202);
+    static constexpr bool has_anchors = (HexVersion >= 0x203);
+    static constexpr bool has_scale_y = (HexVersion >= 0x204);
+    static constexpr bool has_size = (HexVersion >= 0x205);
+
+    static constexpr size_t image_size = 32 + (has_scale_y ? 4 : 0) + (has_size ? 8 : 0);
+    static constexpr size_t anchor_size = 16;
+
+    /// Size of a frame record without images or anchors: reserved bytes, image count, sound index and anchor count.
+    static constexpr size_t min_frame_size = 32 + 4 + 4 + (has_anchors ? 4 : 0);
+
+    /**
+     * Reads count consecutive image records.
+     *
+     * @throws std::out_of_range if data is missing.
+     */
+    static void readImages(const BufferView& buf, Act::Image* images, size_t count)
+    {
+        constexpr size_t word_count = image_size / 4;
+        constexpr size_t rotation_word = (has_scale_y ? 7 : 6);
+
+        buf.require(count * image_size);
+        const uint8_t* src = buf.data() + buf.tell();
+
+        for (size_t i = 0; i < count; i++, src += image_size)
+        {
+            uint32_t words[word_count];
+            std::memcpy(words, src, image_size);
+
+            Act::Image& image = images[i];
+            image.x = words[0];
+            image.y = words[1];
+            image.index = words[2];
+            image.mirror = (words[3] != 0);
+            image.color = Color(words[4]);
+            std::memcpy(&image.scale_x, &words[5], 4);
+            std::memcpy(&image.scale_y, &words[has_scale_y ? 6 : 5], 4);
+            image.rotation = words[rotation_word];
+            image.is_rgba = (words[rotation_word + 1] == 1); // 0 - palette, 1 - rgba
+
+            // dontjump?
+
+            if constexpr (has_size) {
+                image.width = words[9];
+                image.height = words[10];
+            }
+        }
+
+        buf.skip(count * image_size);
+    }
+
+    /**
+     * Reads count consecutive anchor records.
+     *
+     * @throws std::out_of_range if data is missing.
+     */
+    static void readAnchors(const BufferView& buf, Act::Anchor* anchors, size_t count)
+    {
+        buf.require(count * anchor_size);
+        const uint8_t* src = buf.data() + buf.tell();
+
+        for (size_t i = 0; i < count; i++, src += anchor_size)
+        {
+            uint32_t words[anchor_size / 4];
+            std::memcpy(words, src, anchor_size);
+
+            Act::Anchor& anchor = anchors[i];
+            anchor.reserved = words[0]; // unnused
+            anchor.x = words[1];
+            anchor.y = words[2];
+            anchor.attribute = words[3];
+        }
+
+        buf.skip(count * anchor_size);
+    }
+};
+
+/// Calls function with a std::integral_constant of hex_version, which must be supported, so it's instantiated per version.
+template <typename Function>
+void dispatchVersion(int hex_version, Function&& function)
+{
+    switch (hex_version)
+    {
+        case 0x200: function(std::integral_constant<int, 0x200>()); break;
+        case 0x201: function(std::integral_constant<int, 0x201>()); break;
+        case 0x202: function(std::integral_constant<int, 0x202>()); break;
+        case 0x203: function(std::integral_constant<int, 0x203>()); break;
+        case 0x204: function(std::integral_constant<int, 0x204>()); break;
+        case 0x205: function(std::integral_constant<int, 0x205>()); break;
+    }
+}
+
+/**
+ * Reads the header up to and including the reserved bytes, returning the hex version.
+ *
+ * @throws InvalidResource if the magic or version is invalid.
+ * @throws std::out_of_range if data is missing.
+ */
+template <typename Version>
+int readHeader(const BufferView& buf, Version& version, std::array<uint8_t, 10>& reserved, size_t& animation_count)
+{
+    const char act_magic[] = {'A', 'C'};
+    char magic[sizeof(act_magic)];
+
+    buf.read(magic, sizeof(act_magic));
+
+    // Check magic
+    if (std::strncmp(magic, act_magic, sizeof(act_magic)) != 0)
+        throw InvalidResource("act: invalid magic, expected 'AC'");
+
+    const int hex_version = buf.readUint16();
+    version.major = (hex_version >> 8) & 0xFF;
+    version.minor = hex_version & 0xFF;
+
+    // Check version
+    if (hex_version < 0x200 || hex_version > 0x205)
+        throw InvalidResource("act: unsupported version '" + std::to_string(version.major) + '.' + std::to_string(version.minor) + "'");
+
+    // Animation count
+    animation_count = buf.readUint16();
+
+    // Unnused 10 bytes
+    buf.read(reserved.data(), reserved.size());
+
+    return hex_version;
+}
+
+/**
+ * Reads the sound count and paths.
+ *
+ * @throws std::out_of_range if data is missing.
+ */
+inline void readSounds(const BufferView& buf, std::vector<Act::Sound>& sounds)
+{
+    const uint32_t sound_count = buf.readUint32();
+    buf.require(sound_count * sizeof(Act::Sound));
+    sounds.resize(sound_count);
+
+    buf.getArray(sounds.data(), sounds.size());
+
+    for (Act::Sound& sound : sounds)
+        sound.filename[39] = '\0';
+}
+
+/**
+ * Reads the delay of each animation.
+ *
+ * @throws std::out_of_range if data is missing.
+ */
+template <typename Animation>
+void readDelays(const BufferView& buf, std::vector<Animation>& animations)
+{
+    buf.require(animations.size() * 4);
+
+    for (Animation& anim : animations)
+        anim.delay = buf.getFloat();
+}
+
+} // namespace act_records
+} // namespace format
+
+#endif // ROTOOLS_FORMAT_ACTRECORDS_HPP
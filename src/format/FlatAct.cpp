@@ -0,0 +1,235 @@
+#include "FlatAct.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include "ActRecords.hpp"
+#include "Spr.hpp"
+#include "../util/InvalidResource.hpp"
+
+using namespace std;
+
+namespace format {
+
+FlatAct::FlatAct(const Act& act)
+    : version(act.version)
+    , reserved(act.reserved)
+    , sounds(act.sounds)
+{
+    size_t frame_count = 0;
+    size_t image_count = 0;
+    size_t anchor_count = 0;
+
+    for (const Act::Animation& anim : act.animations)
+    {
+        frame_count += anim.frames.size();
+
+        for (const Act::Frame& frame : anim.frames) {
+            image_count += frame.images.size();
+            anchor_count += frame.anchors.size();
+        }
+    }
+
+    animations.reserve(act.animations.size());
+    frames.reserve(frame_count);
+    images.reserve(image_count);
+    anchors.reserve(anchor_count);
+
+    for (const Act::Animation& act_anim : act.animations)
+    {
+        Animation& anim = animations.emplace_back();
+        anim.delay = act_anim.delay;
+        anim.frames = { static_cast<uint32_t>(frames.size()), static_cast<uint32_t>(act_anim.frames.size()) };
+
+        for (const Act::Frame& act_frame : act_anim.frames)
+        {
+            Frame& frame = frames.emplace_back();
+            frame.reserved = act_frame.reserved;
+            frame.sound_index = act_frame.sound_index;
+            frame.images = { static_cast<uint32_t>(images.size()), static_cast<uint32_t>(act_frame.images.size()) };
+            frame.anchors = { static_cast<uint32_t>(anchors.size()), static_cast<uint32_t>(act_frame.anchors.size()) };
+
+            images.insert(images.end(), act_frame.images.begin(), act_frame.images.end());
+            anchors.insert(anchors.end(), act_frame.anchors.begin(), act_frame.anchors.end());
+        }
+    }
+}
+
+/// Reads everything after the header, with the record layout of a version.
+template <int HexVersion>
+static void loadBody(const BufferView& buf, FlatAct& act, size_t animation_count)
+{
+    using Records = act_records::Records<HexVersion>;
+
+    const size_t body_start = buf.tell();
+
+    // Count everything first, so that each array is allocated once
+    size_t frame_count = 0;
+    size_t image_count = 0;
+    size_t anchor_count = 0;
+
+    for (size_t i = 0; i < animation_count; i++)
+    {
+        const uint32_t anim_frame_count = buf.readUint32();
+        frame_count += anim_frame_count;
+
+        for (uint32_t j = 0; j < anim_frame_count; j++)
+        {
+            buf.skip(32);
+
+            const uint32_t frame_image_count = buf.readUint32();
+            buf.skip(frame_image_count * Records::image_size + 4);
+            image_count += frame_image_count;
+
+            if constexpr (Records::has_anchors)
+            {
+                const uint32_t frame_anchor_count = buf.readUint32();
+                buf.skip(frame_anchor_count * Records::anchor_size);
+                anchor_count += frame_anchor_count;
+            }
+        }
+    }
+
+    if (frame_count > UINT32_MAX || image_count > UINT32_MAX || anchor_count > UINT32_MAX)
+        throw InvalidResource("act: too many frames");
+
+    act.animations.assign(animation_count, FlatAct::Animation());
+    act.frames.assign(frame_count, FlatAct::Frame());
+    act.images.assign(image_count, FlatAct::Image());
+    act.anchors.assign(anchor_count, FlatAct::Anchor());
+
+    // Presence of every record was checked above
+    buf.seek(body_start);
+
+    uint32_t frame_offset = 0;
+    uint32_t image_offset = 0;
+    uint32_t anchor_offset = 0;
+
+    for (FlatAct::Animation& anim : act.animations)
+    {
+        anim.frames = { frame_offset, buf.getUint32() };
+        frame_offset += anim.frames.count;
+
+        for (FlatAct::Frame& frame : Span<FlatAct::Frame>(act.frames.data() + anim.frames.offset, anim.frames.count))
+        {
+            buf.getArray(frame.reserved.data(), frame.reserved.size());
+
+            frame.images = { image_offset, buf.getUint32() };
+            image_offset += frame.images.count;
+            Records::readImages(buf, act.images.data() + frame.images.offset, frame.images.count);
+
+            frame.sound_index = buf.getUint32();
+
+            if constexpr (Records::has_anchors) {
+                frame.anchors = { anchor_offset, buf.getUint32() };
+                anchor_offset += frame.anchors.count;
+                Records::readAnchors(buf, act.anchors.data() + frame.anchors.offset, frame.anchors.count);
+            }
+            else {
+                frame.anchors = { anchor_offset, 0 };
+            }
+        }
+    }
+
+    act.sounds.clear();
+
+    if constexpr (Records::has_sounds)
+        act_records::readSounds(buf, act.sounds);
+
+    if constexpr (Records::has_delays)
+        act_records::readDelays(buf, act.animations);
+}
+
+void FlatAct::load(const BufferView& buf)
+try {
+    size_t animation_count;
+    const int hex_version = act_records::readHeader(buf, version, reserved, animation_count);
+
+    act_records::dispatchVersion(hex_version, [&](auto hex) {
+        loadBody<decltype(hex)::value>(buf, *this, animation_count);
+    });
+}
+catch (const out_of_range&) {
+    throw InvalidResource("act: missing data");
+}
+
+Act FlatAct::toAct() const
+{
+    Act act;
+    act.version = version;
+    act.reserved = reserved;
+    act.sounds = sounds;
+    act.animations.resize(animations.size());
+
+    for (size_t i = 0; i < animations.size(); i++)
+    {
+        Act::Animation& act_anim = act.animations[i];
+        act_anim.delay = animations[i].delay;
+        act_anim.frames.reserve(animations[i].frames.count);
+
+        for (const Frame& frame : framesOf(animations[i]))
+        {
+            const Span<const Image> frame_images = imagesOf(frame);
+            const Span<const Anchor> frame_anchors = anchorsOf(frame);
+
+            Act::Frame& act_frame = act_anim.frames.emplace_back();
+            act_frame.reserved = frame.reserved;
+            act_frame.sound_index = frame.sound_index;
+            act_frame.images.assign(frame_images.begin(), frame_images.end());
+            act_frame.anchors.assign(frame_anchors.begin(), frame_anchors.end());
+        }
+    }
+
+    return act;
+}
+
+vector<FlatAct::Bounds> FlatAct::frameBounds(const Spr& spr) const
+{
+    vector<Bounds> bounds(frames.size());
+
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        float left = INFINITY, top = INFINITY, right = -INFINITY, bottom = -INFINITY;
+
+        for (const Image& image : imagesOf(frames[i]))
+        {
+            const size_t index = static_cast<size_t>(image.index);
+
+            // Rgba images and images scaled down to nothing aren't drawn
+            if (image.index < 0 || index >= spr.palette_images.size() || image.is_rgba || image.scale_x == 0 || image.scale_y == 0)
+                continue;
+
+            const int w = spr.palette_images[index].width;
+            const int h = spr.palette_images[index].height;
+
+            // Images are centered on their position, then scaled and rotated around it. Mirroring doesn't change their extent.
+            const float x0 = -round(w / 2.0) * image.scale_x;
+            const float x1 = (w - round(w / 2.0)) * image.scale_x;
+            const float y0 = -round(h / 2.0) * image.scale_y;
+            const float y1 = (h - round(h / 2.0)) * image.scale_y;
+            const float angle = image.rotation * static_cast<float>(M_PI) / 180.f;
+            const float cos_a = cos(angle);
+            const float sin_a = sin(angle);
+
+            for (float x : {x0, x1})
+            {
+                for (float y : {y0, y1})
+                {
+                    const float rotated_x = image.x + x * cos_a - y * sin_a;
+                    const float rotated_y = image.y + x * sin_a + y * cos_a;
+
+                    left = min(left, rotated_x);
+                    right = max(right, rotated_x);
+                    top = min(top, rotated_y);
+                    bottom = max(bottom, rotated_y);
+                }
+            }
+        }
+
+        if (left <= right && top <= bottom)
+            bounds[i] = { static_cast<int>(floor(left)), static_cast<int>(floor(top)), static_cast<int>(ceil(right)), static_cast<int>(ceil(bottom)) };
+    }
+
+    return bounds;
+}
+
+} // namespace format
@@ -0,0 +1,106 @@
+#ifndef ROTOOLS_FORMAT_FLATACT_HPP
+#define ROTOOLS_FORMAT_FLATACT_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "Act.hpp"
+#include "../util/Buffer.hpp"
+#include "../util/Span.hpp"
+
+namespace format {
+
+struct Spr;
+
+/**
+ * Act whose frames, images and anchors are each stored in one contiguous array.
+ *
+ * Animations refer to their frames, and frames to their images and anchors,
+ * through ranges of those arrays, so loading takes a handful of allocations
+ * regardless of how many frames an act has.
+ */
+struct FlatAct {
+    using Image = Act::Image;
+    using Anchor = Act::Anchor;
+    using Sound = Act::Sound;
+
+    /// Consecutive elements of one of the arrays.
+    struct Range {
+        uint32_t offset = 0;
+        uint32_t count = 0;
+    };
+
+    struct Frame {
+        std::array<uint8_t, 32> reserved{}; // unused ranges, kept so saving is byte-exact
+        int sound_index = -1;
+        Range images;
+        Range anchors;
+    };
+
+    struct Animation {
+        float delay = 4.f;
+        Range frames;
+    };
+
+    /// Axis-aligned box in pixels, relative to the frame's center. Right and bottom are exclusive.
+    struct Bounds {
+        int left = 0;
+        int top = 0;
+        int right = 0;
+        int bottom = 0;
+
+        bool empty() const noexcept { return right <= left || bottom <= top; }
+
+        bool intersects(const Bounds& other) const noexcept
+        {
+            return !empty() && !other.empty()
+                && left < other.right && other.left < right
+                && top < other.bottom && other.top < bottom;
+        }
+
+        Bounds translated(int x, int y) const noexcept { return { left + x, top + y, right + x, bottom + y }; }
+    };
+
+    /// Constructs an empty FlatAct.
+    explicit FlatAct() = default;
+
+    /// Construct and loads from memory buffer.
+    explicit FlatAct(const BufferView& buf) { load(buf); }
+
+    /// Constructs from an Act.
+    explicit FlatAct(const Act& act);
+
+    /**
+     * Loads from memory buffer.
+     *
+     * @throws InvalidResource on failure.
+     */
+    void load(const BufferView& buf);
+
+    /// Converts to an Act.
+    Act toAct() const;
+
+    /**
+     * Bounds of each frame, in the frames array's order, covering every
+     * palette image with its scale and rotation applied, as drawn by
+     * ROSprite. Images are sized after their spr images; rgba images and
+     * images missing from spr are left out.
+     */
+    std::vector<Bounds> frameBounds(const Spr& spr) const;
+
+    Span<const Frame> framesOf(const Animation& anim) const noexcept { return { frames.data() + anim.frames.offset, anim.frames.count }; }
+    Span<const Image> imagesOf(const Frame& frame) const noexcept { return { images.data() + frame.images.offset, frame.images.count }; }
+    Span<const Anchor> anchorsOf(const Frame& frame) const noexcept { return { anchors.data() + frame.anchors.offset, frame.anchors.count }; }
+
+    decltype(Act::version) version;
+    std::array<uint8_t, 10> reserved{}; // unused, kept so saving is byte-exact
+    std::vector<Animation> animations;
+    std::vector<Frame> frames;
+    std::vector<Image> images;
+    std::vector<Anchor> anchors;
+    std::vector<Sound> sounds;
+};
+
+} // namespace format
+
+#endif // ROTOOLS_FORMAT_FLATACT_HPP
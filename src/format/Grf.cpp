@@ -0,0 +1,170 @@
+#include "Grf.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+#include "../util/InvalidResource.hpp"
+
+using namespace std;
+
+namespace format {
+
+string Grf::normalize(string_view path)
+{
+    string normalized(path);
+
+    for (size_t i = 0; i < normalized.size(); i++)
+    {
+        const unsigned char c = normalized[i];
+
+        if (c >= 0x81) {
+            i++; // CP949 lead byte, keep its trail byte as is
+        }
+        else if (c == '/') {
+            normalized[i] = '\\';
+        }
+        else if (c >= 'A' && c <= 'Z') {
+            normalized[i] = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+
+    return normalized;
+}
+
+void Grf::open(const char* filename)
+try {
+    file_ = mapFile(filename);
+    filename_ = filename;
+    entries_.clear();
+    index_.clear();
+
+    const char grf_magic[] = "Master of Magic";
+    char magic[16];
+
+    file_.read(magic, sizeof(magic));
+
+    // Check magic
+    if (memcmp(magic, grf_magic, sizeof(grf_magic)) != 0)
+        throw InvalidResource("grf: invalid magic, expected 'Master of Magic'");
+
+    // Encryption key, unnused
+    file_.skip(14);
+
+    const uint32_t table_offset = file_.readUint32();
+    const uint32_t seed = file_.readUint32();
+    const uint32_t raw_file_count = file_.readUint32();
+    version_ = file_.readUint32();
+
+    if (version_ != 0x200)
+        throw InvalidResource("grf: unsupported version '" + to_string(version_ >> 8) + '.' + to_string(version_ & 0xFF) + "'");
+
+    const size_t file_count = raw_file_count - seed - 7;
+
+    // Decompress the file table
+    file_.seek(header_size + static_cast<size_t>(table_offset));
+
+    const uint32_t table_compressed_size = file_.readUint32();
+    const uint32_t table_size = file_.readUint32();
+    file_.require(table_compressed_size);
+
+    // Deflate expands at most 1032:1, which bounds a bogus table size
+    if (table_size > static_cast<uint64_t>(table_compressed_size) * 1032)
+        throw InvalidResource("grf: corrupted file table");
+
+    table_.resize(table_size);
+    uLongf dest_size = table_size;
+
+    if (uncompress(reinterpret_cast<Bytef*>(table_.data()), &dest_size,
+                   file_.data() + file_.tell(), table_compressed_size) != Z_OK || dest_size != table_size)
+        throw InvalidResource("grf: corrupted file table");
+
+    // Index entries
+    const BufferView table(table_.data(), table_.size());
+
+    // Every entry takes at least 18 bytes, which bounds a bogus file count
+    const size_t max_entries = min(file_count, table_.size() / 18);
+    entries_.reserve(max_entries);
+    index_.reserve(max_entries);
+
+    while (table.remaining())
+    {
+        const char* name = reinterpret_cast<const char*>(table.data() + table.tell());
+        const void* name_end = memchr(name, '\0', table.remaining());
+
+        if (!name_end)
+            throw InvalidResource("grf: unterminated filename in file table");
+
+        Entry entry;
+        entry.filename = string_view(name, static_cast<const char*>(name_end) - name);
+        table.skip(entry.filename.size() + 1);
+
+        table.require(17);
+        entry.compressed_size = table.getUint32();
+        entry.compressed_size_aligned = table.getUint32();
+        entry.size = table.getUint32();
+        entry.flags = table.getUint8();
+        entry.offset = table.getUint32();
+
+        // Directories have no data
+        if (!(entry.flags & Entry::File))
+            continue;
+
+        // Later duplicates replace earlier ones, the same as the game client
+        auto result = index_.emplace(normalize(entry.filename), entries_.size());
+
+        if (!result.second)
+            entries_[result.first->second] = entry;
+        else
+            entries_.push_back(entry);
+    }
+}
+catch (const out_of_range&) {
+    throw InvalidResource("grf: missing data");
+}
+
+const Grf::Entry* Grf::find(string_view path) const
+{
+    auto iter = index_.find(normalize(path));
+    return iter != index_.end() ? &entries_[iter->second] : nullptr;
+}
+
+BufferView Grf::rawData(const Entry& entry) const
+{
+    const size_t begin = header_size + static_cast<size_t>(entry.offset);
+
+    if (begin > file_.size() || entry.compressed_size_aligned > file_.size() - begin)
+        throw InvalidResource("grf: entry '" + string(entry.filename) + "' is out of the archive's bounds");
+
+    return BufferView(file_.data() + begin, entry.compressed_size_aligned);
+}
+
+Buffer Grf::read(const Entry& entry) const
+{
+    if (entry.flags & (Entry::MixCrypt | Entry::DesHeader))
+        throw InvalidResource("grf: entry '" + string(entry.filename) + "' is encrypted, which is not supported");
+
+    const BufferView raw = rawData(entry);
+
+    if (entry.compressed_size > raw.size())
+        throw InvalidResource("grf: entry '" + string(entry.filename) + "' has an invalid compressed size");
+
+    Buffer buf(entry.size);
+    uLongf dest_size = entry.size;
+
+    if (entry.size && (uncompress(buf.data(), &dest_size, raw.data(), entry.compressed_size) != Z_OK || dest_size != entry.size))
+        throw InvalidResource("grf: entry '" + string(entry.filename) + "' is corrupted");
+
+    return buf;
+}
+
+Buffer Grf::read(string_view path) const
+{
+    const Entry* entry = find(path);
+
+    if (!entry)
+        throw InvalidResource("grf: no such entry '" + string(path) + "'");
+
+    return read(*entry);
+}
+
+} // namespace format
\ No newline at end of file
@@ -0,0 +1,103 @@
+#ifndef ROTOOLS_FORMAT_GRF_HPP
+#define ROTOOLS_FORMAT_GRF_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "../util/Buffer.hpp"
+#include "../util/MappedFile.hpp"
+
+namespace format {
+
+/**
+ * Read-only GRF archive.
+ *
+ * The archive is memory-mapped and its file table is decompressed once into
+ * a hash index, so entries are looked up in constant time and inflated on
+ * demand. Reading entries is thread-safe.
+ */
+class Grf final {
+public:
+    struct Entry {
+        enum Flags : uint8_t {
+            File = 0x01,      // entry is a file rather than a directory
+            MixCrypt = 0x02,  // data is DES-encrypted in mixed mode
+            DesHeader = 0x04  // only the first 0x14 blocks are DES-encrypted
+        };
+
+        std::string_view filename;  // filename as stored in the archive
+        uint32_t compressed_size;
+        uint32_t compressed_size_aligned;
+        uint32_t size;              // uncompressed size
+        uint32_t offset;            // data offset relative to the end of the header
+        uint8_t flags;
+    };
+
+    /// Size of the archive header.
+    static constexpr size_t header_size = 46;
+
+    /**
+     * Normalizes a path for lookup: ASCII letters become lowercase and
+     * slashes become backslashes. Multibyte CP949 characters are kept intact.
+     */
+    static std::string normalize(std::string_view path);
+
+    /// Constructs a closed archive.
+    explicit Grf() = default;
+
+    /// Constructs and opens an archive file.
+    explicit Grf(const char* filename) { open(filename); }
+
+    /**
+     * Maps an archive file and indexes its file table.
+     *
+     * @throws FileNotOpen if the file cannot be mapped.
+     * @throws InvalidResource if the archive is invalid.
+     */
+    void open(const char* filename);
+
+    /// Looks up an entry by path, regardless of case and slash direction.
+    const Entry* find(std::string_view path) const;
+
+    /// Whether a file exists in the archive.
+    bool contains(std::string_view path) const { return find(path) != nullptr; }
+
+    /**
+     * Decompresses an entry's data.
+     *
+     * @throws InvalidResource if the entry is encrypted or its data is corrupted.
+     */
+    Buffer read(const Entry& entry) const;
+
+    /**
+     * Decompresses the data of the entry at path.
+     *
+     * @throws InvalidResource if there's no such entry or it cannot be read.
+     */
+    Buffer read(std::string_view path) const;
+
+    /// View of an entry's data as stored in the archive.
+    BufferView rawData(const Entry& entry) const;
+
+    /// All file entries in archive order.
+    const std::vector<Entry>& entries() const { return entries_; }
+
+    uint32_t version() const { return version_; }
+
+    /// Filename the archive was opened from.
+    const std::string& filename() const { return filename_; }
+
+private:
+    MappedFile file_;
+    std::string filename_;
+    uint32_t version_ = 0;
+    std::vector<char> table_;             // decompressed file table, entries' filenames point into it
+    std::vector<Entry> entries_;
+    std::unordered_map<std::string, size_t> index_; // normalized filename -> entry index
+};
+
+} // namespace format
+
+#endif // ROTOOLS_FORMAT_GRF_HPP
@@ -0,0 +1,349 @@
+#include "GrfWriter.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <mutex>
+#include <system_error>
+#include <zlib.h>
+#include "../util/InvalidResource.hpp"
+#include "../util/MappedFile.hpp"
+#include "../util/MemoryBudget.hpp"
+#include "../util/filehandler.hpp"
+
+using namespace std;
+
+namespace format {
+
+/// Compresses data into a zlib stream.
+static Buffer compress(const BufferView& data)
+{
+    uLongf size = compressBound(data.size());
+    vector<uint8_t> compressed(size);
+
+    if (compress2(compressed.data(), &size, data.data(), data.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+        throw InvalidResource("grf: could not compress data");
+
+    compressed.resize(size);
+    return Buffer(move(compressed));
+}
+
+/// Writes a buffer's bytes to a stream.
+static void writeBytes(ostream& out, const void* data, size_t size)
+{
+    out.write(static_cast<const char*>(data), size);
+}
+
+/// Narrows an archive offset or size, which GRF stores in 32 bits.
+static uint32_t checkedUint32(size_t value)
+{
+    if (value > numeric_limits<uint32_t>::max())
+        throw InvalidResource("grf: archive exceeds 4 GB");
+
+    return static_cast<uint32_t>(value);
+}
+
+GrfWriter::GrfWriter(const char* base_filename)
+    : base_filename_{ base_filename }
+    , base_{ base_filename } {}
+
+void GrfWriter::add(string_view path, Buffer data)
+{
+    const size_t size = data.size();
+    addPending(path, Pending{ string(path), move(data), string(), size });
+}
+
+void GrfWriter::addFile(string_view path, string source_filename)
+{
+    error_code ec;
+    const size_t size = filesystem::file_size(source_filename, ec);
+
+    if (ec)
+        throw FileNotOpen(source_filename);
+
+    addPending(path, Pending{ string(path), Buffer(), move(source_filename), size });
+}
+
+void GrfWriter::addPending(string_view path, Pending pending)
+{
+    string key = Grf::normalize(path);
+    removed_.erase(key);
+
+    auto iter = pending_index_.find(key);
+
+    if (iter != pending_index_.end()) {
+        pending_[iter->second] = move(pending);
+        return;
+    }
+
+    pending_index_.emplace(move(key), pending_.size());
+    pending_.push_back(move(pending));
+}
+
+void GrfWriter::remove(string_view path)
+{
+    string key = Grf::normalize(path);
+    auto iter = pending_index_.find(key);
+
+    if (iter != pending_index_.end())
+    {
+        // Leave the slot in place so other indices stay valid
+        pending_[iter->second] = Pending();
+        pending_index_.erase(iter);
+    }
+
+    removed_.insert(move(key));
+}
+
+GrfWriter::Compressed GrfWriter::compressPending(const Pending& pending) const
+{
+    const MappedFile source = pending.source.empty() ? MappedFile() : mapFile(pending.source.c_str());
+    const BufferView& data = pending.source.empty() ? static_cast<const BufferView&>(pending.data) : source;
+    const Grf::Entry* base_entry = base_.find(Grf::normalize(pending.filename));
+
+    Compressed result;
+    result.size = data.size();
+
+    // Same size as the base entry: check whether the content changed at all
+    if (base_entry && base_entry->size == data.size() && !(base_entry->flags & (Grf::Entry::MixCrypt | Grf::Entry::DesHeader)))
+    {
+        const Buffer base_data = base_.read(*base_entry);
+
+        if (memcmp(base_data.data(), data.data(), base_data.size()) == 0) {
+            result.unchanged = base_entry;
+            return result;
+        }
+    }
+
+    result.data = compress(data);
+    return result;
+}
+
+Buffer GrfWriter::serializeHeader(uint32_t table_offset, size_t entry_count)
+{
+    const char grf_magic[16] = "Master of Magic";
+
+    Buffer buf;
+    buf.reserve(Grf::header_size);
+    buf.write(grf_magic, sizeof(grf_magic));
+
+    // Encryption key, unnused
+    const uint8_t key[14] = {};
+    buf.write(key, sizeof(key));
+
+    buf.writeUint32(table_offset);
+    buf.writeUint32(0); // seed
+    buf.writeUint32(checkedUint32(entry_count + 7));
+    buf.writeUint32(0x200);
+
+    return buf;
+}
+
+Buffer GrfWriter::serializeTable(const vector<OutputEntry>& entries)
+{
+    size_t table_size = 0;
+
+    for (const OutputEntry& entry : entries)
+        table_size += entry.filename.size() + 1 + 17;
+
+    Buffer table;
+    table.reserve(table_size);
+
+    for (const OutputEntry& entry : entries)
+    {
+        table.write(entry.filename.data(), entry.filename.size());
+        table.writeUint8(0);
+        table.writeUint32(entry.compressed_size);
+        table.writeUint32(entry.compressed_size_aligned);
+        table.writeUint32(entry.size);
+        table.writeUint8(entry.flags);
+        table.writeUint32(entry.offset);
+    }
+
+    const Buffer compressed = compress(table);
+
+    Buffer buf;
+    buf.reserve(8 + compressed.size());
+    buf.writeUint32(checkedUint32(compressed.size()));
+    buf.writeUint32(checkedUint32(table.size()));
+    buf.write(compressed.data(), compressed.size());
+
+    return buf;
+}
+
+GrfWriter::Stats GrfWriter::writeArchive(ostream& out, const string& filename, bool copy_base, size_t data_end, size_t max_in_flight, ThreadPool& pool) const
+{
+    Stats stats;
+    vector<OutputEntry> entries;
+    entries.reserve(base_.entries().size() + pending_.size());
+
+    // Pending files to compress and the entry each one fills in
+    vector<pair<size_t, size_t>> added; // entry index, pending index
+
+    size_t offset = data_end;
+    out.seekp(Grf::header_size + offset);
+
+    // Guards out, offset and stats once compression tasks run
+    mutex out_mutex;
+
+    // Appends data at the end of the archive's data
+    auto append = [&](const void* data, size_t size) {
+        writeBytes(out, data, size);
+        const uint32_t data_offset = checkedUint32(offset);
+        offset += size;
+        stats.written_bytes += size;
+        return data_offset;
+    };
+
+    // Keeps an entry of the base archive, copying its bytes when rewriting it
+    auto keep = [&](const Grf::Entry& entry) {
+        OutputEntry output{ entry.filename, entry.compressed_size, entry.compressed_size_aligned, entry.size, entry.offset, entry.flags };
+
+        if (copy_base) {
+            const BufferView raw = base_.rawData(entry);
+            output.offset = append(raw.data(), raw.size());
+        }
+
+        stats.reused_count++;
+        return output;
+    };
+
+    // Reserves an entry for a pending file, filled in once compressed
+    auto add = [&](size_t index) {
+        added.emplace_back(entries.size(), index);
+        entries.push_back({});
+    };
+
+    // Base entries keep their order, replaced ones included
+    for (const Grf::Entry& entry : base_.entries())
+    {
+        const string key = Grf::normalize(entry.filename);
+
+        if (removed_.count(key))
+            continue;
+
+        auto iter = pending_index_.find(key);
+
+        if (iter != pending_index_.end())
+            add(iter->second);
+        else
+            entries.push_back(keep(entry));
+    }
+
+    // New files follow
+    for (size_t i = 0; i < pending_.size(); i++)
+    {
+        auto iter = pending_index_.find(Grf::normalize(pending_[i].filename));
+
+        if (iter != pending_index_.end() && iter->second == i && !base_.find(iter->first))
+            add(i);
+    }
+
+    // Each file is written as soon as it's compressed, in whatever order that happens
+    MemoryBudget budget(max_in_flight);
+    vector<future<void>> futures;
+    futures.reserve(added.size());
+
+    for (const pair<size_t, size_t>& job : added)
+    {
+        // Its data plus either the compressed copy or the base entry's data it's compared with.
+        // Waiting here bounds the data read and compressed at once.
+        const size_t reserved = 2 * pending_[job.second].size;
+        budget.acquire(reserved);
+
+        futures.push_back(pool.submit([&, job, reserved] {
+            const Pending& pending = pending_[job.second];
+            OutputEntry& output = entries[job.first];
+
+            try {
+                const Compressed compressed = compressPending(pending);
+                lock_guard<mutex> lock(out_mutex);
+
+                if (compressed.unchanged) {
+                    output = keep(*compressed.unchanged);
+                }
+                else {
+                    const uint32_t size = checkedUint32(compressed.data.size());
+                    output = { pending.filename, size, size, checkedUint32(compressed.size), append(compressed.data.data(), size), Grf::Entry::File };
+                    stats.compressed_count++;
+                }
+            }
+            catch (...) {
+                budget.release(reserved);
+                throw;
+            }
+
+            budget.release(reserved);
+        }));
+    }
+
+    // Every task refers to this frame, so let them all finish before rethrowing
+    for (future<void>& result : futures)
+        result.wait();
+
+    for (future<void>& result : futures)
+        result.get();
+
+    const Buffer table = serializeTable(entries);
+    const uint32_t table_offset = checkedUint32(offset);
+    writeBytes(out, table.data(), table.size());
+
+    // The header goes last, so an interrupted write leaves it pointing to the previous table
+    if (!out.flush())
+        throw FileNotOpen(filename);
+
+    const Buffer header = serializeHeader(table_offset, entries.size());
+    out.seekp(0);
+    writeBytes(out, header.data(), header.size());
+
+    if (!out.flush())
+        throw FileNotOpen(filename);
+
+    stats.entry_count = entries.size();
+    stats.written_bytes += table.size() + header.size();
+    stats.archive_size = Grf::header_size + table_offset + table.size();
+    return stats;
+}
+
+GrfWriter::Stats GrfWriter::write(const char* filename, ThreadPool& pool, size_t max_in_flight) const
+{
+    ofstream ofs(filename, ofstream::binary | ofstream::trunc);
+
+    if (!ofs)
+        throw FileNotOpen(filename);
+
+    return writeArchive(ofs, filename, true, 0, max_in_flight, pool);
+}
+
+GrfWriter::Stats GrfWriter::patch(ThreadPool& pool, size_t max_in_flight)
+{
+    if (base_filename_.empty())
+        throw InvalidResource("grf: there's no base archive to patch");
+
+    // New data goes after everything in the file, old file table included, so
+    // the archive stays valid until the new header replaces the old one
+    const size_t file_size = filesystem::file_size(base_filename_);
+    const size_t data_end = file_size > Grf::header_size ? file_size - Grf::header_size : 0;
+
+    Stats stats;
+
+    {
+        fstream fs(base_filename_, fstream::in | fstream::out | fstream::binary);
+
+        if (!fs)
+            throw FileNotOpen(base_filename_);
+
+        stats = writeArchive(fs, base_filename_, false, data_end, max_in_flight, pool);
+    }
+
+    base_.open(base_filename_.c_str());
+    pending_.clear();
+    pending_index_.clear();
+    removed_.clear();
+
+    return stats;
+}
+
+} // namespace format
@@ -0,0 +1,130 @@
+#ifndef ROTOOLS_FORMAT_GRFWRITER_HPP
+#define ROTOOLS_FORMAT_GRFWRITER_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Grf.hpp"
+#include "../util/Buffer.hpp"
+#include "../util/ThreadPool.hpp"
+
+namespace format {
+
+/**
+ * Builds GRF archives, optionally on top of an existing one.
+ *
+ * Added files are compressed in parallel and written as they complete,
+ * with the data read and compressed at once bounded by a memory budget.
+ * Files added from disk are only read then. Files of the base archive that
+ * are not replaced keep their compressed bytes, and so do added files whose
+ * content matches the base archive's. Patching appends only changed files
+ * to the base archive instead of rewriting it.
+ */
+class GrfWriter final {
+public:
+    struct Stats {
+        size_t entry_count = 0;      // entries in the resulting archive
+        size_t compressed_count = 0; // added files that had to be compressed
+        size_t reused_count = 0;     // entries whose compressed bytes were kept
+        size_t written_bytes = 0;    // bytes written to disk
+        size_t archive_size = 0;     // size of the resulting archive file
+    };
+
+    static constexpr size_t default_max_in_flight = 256 * 1024 * 1024;
+
+    /// Constructs a writer for a new archive.
+    explicit GrfWriter() = default;
+
+    /**
+     * Constructs a writer based on an existing archive.
+     *
+     * @throws FileNotOpen if the archive cannot be opened.
+     * @throws InvalidResource if the archive is invalid.
+     */
+    explicit GrfWriter(const char* base_filename);
+
+    /// Adds a file, replacing any file with the same normalized path.
+    void add(std::string_view path, Buffer data);
+
+    /**
+     * Adds a file read from source_filename when the archive is written,
+     * replacing any file with the same normalized path.
+     *
+     * @throws FileNotOpen if the file doesn't exist.
+     */
+    void addFile(std::string_view path, std::string source_filename);
+
+    /// Removes a file of the base archive or a previously added one.
+    void remove(std::string_view path);
+
+    /**
+     * Writes a complete archive to filename, which must not be the base
+     * archive, holding about max_in_flight bytes of added files at most.
+     *
+     * @throws FileNotOpen if the file cannot be written or an added file read.
+     * @throws InvalidResource if an entry cannot be read or compressed.
+     */
+    Stats write(const char* filename, ThreadPool& pool, size_t max_in_flight = default_max_in_flight) const;
+
+    /**
+     * Updates the base archive in place, appending changed files and a new
+     * file table after its current end. The header is rewritten last, so the
+     * archive keeps its previous content if patching is interrupted. Space
+     * held by replaced files and old tables is not reclaimed; write() a new
+     * archive to compact it. Memory is bounded as in write().
+     *
+     * @throws FileNotOpen if the base archive cannot be written or an added file read.
+     * @throws InvalidResource if there's no base archive or an entry cannot be read or compressed.
+     */
+    Stats patch(ThreadPool& pool, size_t max_in_flight = default_max_in_flight);
+
+private:
+    struct Pending {
+        std::string filename;
+        Buffer data;
+        std::string source; // file to read data from, if not empty
+        size_t size = 0;    // of data or source when added
+    };
+
+    /// Compression result of a pending file.
+    struct Compressed {
+        const Grf::Entry* unchanged = nullptr; // base entry with the same content, if any
+        Buffer data;
+        size_t size = 0; // uncompressed
+    };
+
+    /// Entry of the archive being written.
+    struct OutputEntry {
+        std::string_view filename;
+        uint32_t compressed_size;
+        uint32_t compressed_size_aligned;
+        uint32_t size;
+        uint32_t offset;
+        uint8_t flags;
+    };
+
+    void addPending(std::string_view path, Pending pending);
+
+    /// Reads a pending file, if needed, and compresses it unless the base archive has it unchanged.
+    Compressed compressPending(const Pending& pending) const;
+
+    /// Writes entry data from data_end onwards, then the file table and, once flushed, the header.
+    Stats writeArchive(std::ostream& out, const std::string& filename, bool copy_base, size_t data_end, size_t max_in_flight, ThreadPool& pool) const;
+
+    static Buffer serializeHeader(uint32_t table_offset, size_t entry_count);
+    static Buffer serializeTable(const std::vector<OutputEntry>& entries);
+
+    std::string base_filename_;
+    Grf base_;
+    std::vector<Pending> pending_;
+    std::unordered_map<std::string, size_t> pending_index_; // normalized path -> pending index
+    std::unordered_set<std::string> removed_;               // normalized paths
+};
+
+} // namespace format
+
+#endif // ROTOOLS_FORMAT_GRFWRITER_HPP
@@ -81,7 +81,7 @@ void Image::saveAsBmp(Buffer& buf, int width, int height, int channels, const vo
     FreeImage_CloseMemory(hmem);
 }
 
-void Image::load(const Buffer& buf)
+void Image::load(const BufferView& buf)
 {
     const BYTE* cdata = reinterpret_cast<const BYTE*>(buf.data());
     BYTE* data = const_cast<BYTE*>(cdata);
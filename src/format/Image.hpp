@@ -15,14 +15,14 @@ struct Image {
     explicit Image() = default;
     explicit Image(Image&&) = default;
     explicit Image(const Image&) = delete;
-    explicit Image(const Buffer& buf) { load(buf); }
+    explicit Image(const BufferView& buf) { load(buf); }
 
     /**
      * Loads from memory buffer.
      *
      * @throws InvalidResource on failure.
      */
-    void load(const Buffer& buf);
+    void load(const BufferView& buf);
 
     int width;
     int height;
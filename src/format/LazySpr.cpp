@@ -0,0 +1,108 @@
+#include "LazySpr.hpp"
+
+#include <cstring>
+#include "../util/InvalidResource.hpp"
+
+using namespace std;
+
+namespace format {
+
+void LazySpr::open(const char* filename)
+{
+    MappedFile file(filename);
+    load(file);
+    file_ = move(file);
+}
+
+void LazySpr::load(const BufferView& buf)
+{
+    layout_ = Spr::scan(buf);
+    version = layout_.version;
+
+    pal.reset();
+
+    if (((version.major << 8) | version.minor) >= 0x101)
+        pal = make_unique<Pal>(buf);
+
+    data_ = BufferView(buf.data(), buf.size());
+
+    palette_images_.clear();
+    rgba_images_.clear();
+    palette_images_.resize(layout_.palette_images.size());
+    rgba_images_.resize(layout_.rgba_images.size());
+
+    lru_.clear();
+    lru_pos_.assign(palette_images_.size() + rgba_images_.size(), lru_.end());
+}
+
+void LazySpr::setMaxDecoded(size_t max_decoded)
+{
+    max_decoded_ = max_decoded;
+    evict();
+}
+
+const Spr::PaletteImage& LazySpr::paletteImage(size_t index)
+{
+    auto& decoded = palette_images_.at(index);
+
+    if (!decoded)
+    {
+        const ImageInfo& info = layout_.palette_images[index];
+        Spr::PaletteImage image{ info.width, info.height, {} };
+        image.indices.resize(static_cast<size_t>(info.width) * info.height);
+        Spr::readPaletteImage(data_, version, info, image.indices.data());
+
+        // Cache only once decoded, so a failed decode isn't returned later
+        decoded = move(image);
+    }
+
+    touch(index);
+    return *decoded;
+}
+
+const Spr::RgbaImage& LazySpr::rgbaImage(size_t index)
+{
+    auto& decoded = rgba_images_.at(index);
+
+    if (!decoded)
+    {
+        const ImageInfo& info = layout_.rgba_images[index];
+        Spr::RgbaImage image{ info.width, info.height, {} };
+        image.pixels.resize(static_cast<size_t>(info.width) * info.height);
+        memcpy(image.pixels.data(), data_.data() + info.offset, info.size);
+        decoded = move(image);
+    }
+
+    touch(palette_images_.size() + index);
+    return *decoded;
+}
+
+void LazySpr::touch(size_t key)
+{
+    if (lru_pos_[key] != lru_.end())
+        lru_.splice(lru_.begin(), lru_, lru_pos_[key]);
+    else
+        lru_pos_[key] = lru_.insert(lru_.begin(), key);
+
+    evict();
+}
+
+void LazySpr::evict()
+{
+    if (!max_decoded_)
+        return;
+
+    while (lru_.size() > max_decoded_)
+    {
+        const size_t key = lru_.back();
+        lru_.pop_back();
+        lru_pos_[key] = lru_.end();
+
+        if (key < palette_images_.size())
+            palette_images_[key].reset();
+        else
+            rgba_images_[key - palette_images_.size()].reset();
+    }
+}
+
+} // namespace format
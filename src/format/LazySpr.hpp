@@ -0,0 +1,97 @@
+#ifndef ROTOOLS_FORMAT_LAZYSPR_HPP
+#define ROTOOLS_FORMAT_LAZYSPR_HPP
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "Pal.hpp"
+#include "Spr.hpp"
+#include "../util/BufferView.hpp"
+#include "../util/MappedFile.hpp"
+
+namespace format {
+
+/**
+ * Spr whose images are decoded on first access.
+ *
+ * Loading only scans the file for each image's dimensions and data offset,
+ * so opening a spr with hundreds of images is cheap and tools that only
+ * need sizes never decode anything. Decoded images may be capped, in which
+ * case the least recently used ones are dropped.
+ *
+ * Image indices match Spr's, which skips empty images as well.
+ */
+class LazySpr final {
+public:
+    using ImageInfo = Spr::ImageInfo;
+
+    /// Constructs an empty LazySpr.
+    explicit LazySpr() = default;
+
+    /// Constructs and opens a spr file.
+    explicit LazySpr(const char* filename, size_t max_decoded = 0)
+        : max_decoded_{ max_decoded } { open(filename); }
+
+    /**
+     * Maps a spr file and scans it.
+     *
+     * @throws FileNotOpen if the file cannot be mapped.
+     * @throws InvalidResource if the file is invalid.
+     */
+    void open(const char* filename);
+
+    /**
+     * Scans a spr in memory, which must outlive this object.
+     *
+     * @throws InvalidResource on failure.
+     */
+    void load(const BufferView& buf);
+
+    /// Limits how many images are kept decoded at once, or none if zero.
+    void setMaxDecoded(size_t max_decoded);
+
+    size_t maxDecoded() const noexcept { return max_decoded_; }
+
+    /// Number of images currently decoded.
+    size_t decodedCount() const noexcept { return lru_.size(); }
+
+    const std::vector<ImageInfo>& paletteImageInfos() const noexcept { return layout_.palette_images; }
+    const std::vector<ImageInfo>& rgbaImageInfos() const noexcept { return layout_.rgba_images; }
+
+    /**
+     * Decodes a palette image if needed. The reference is valid until an
+     * image is evicted to make room for another.
+     *
+     * @throws InvalidResource if the image data is invalid.
+     */
+    const Spr::PaletteImage& paletteImage(size_t index);
+
+    /// Decodes an rgba image if needed, the same as paletteImage().
+    const Spr::RgbaImage& rgbaImage(size_t index);
+
+    Spr::Version version;
+    std::unique_ptr<Pal> pal;
+
+private:
+    /// Marks an image as most recently used, evicting others if over the cap.
+    void touch(size_t key);
+    void evict();
+
+    MappedFile file_;
+    BufferView data_;
+    size_t max_decoded_ = 0;
+
+    Spr::Layout layout_;
+    std::vector<std::optional<Spr::PaletteImage>> palette_images_;
+    std::vector<std::optional<Spr::RgbaImage>> rgba_images_;
+
+    // Keys are palette image indices followed by rgba image indices
+    std::list<size_t> lru_;                           // most recently used first
+    std::vector<std::list<size_t>::iterator> lru_pos_;
+};
+
+} // namespace format
+
+#endif // ROTOOLS_FORMAT_LAZYSPR_HPP
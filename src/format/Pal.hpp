@@ -14,18 +14,21 @@ struct Pal {
     explicit Pal() = default;
 
     /// Constructs and loads from memory buffer.
-    explicit Pal(const Buffer& buf) { load(buf); }
+    explicit Pal(const BufferView& buf) { load(buf); }
 
     /**
      * Loads from memory buffer.
      *
      * @throws InvalidResource on failure.
      */
-    void load(const Buffer& buf);
+    void load(const BufferView& buf);
 
     /// Saves to memory buffer.
     void save(Buffer& buf) const;
 
+    /// Number of bytes written by save().
+    size_t serializedSize() const { return colors.size() * sizeof(Color); }
+
     std::array<Color, 256> colors;
 };
 
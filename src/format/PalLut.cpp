@@ -0,0 +1,88 @@
+#include "PalLut.hpp"
+
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ROTOOLS_PALLUT_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace format {
+
+namespace {
+
+using ExpandFunction = void (*)(const uint32_t*, const uint8_t*, size_t, uint8_t*);
+
+void expandScalar(const uint32_t* lut, const uint8_t* indices, size_t count, uint8_t* dest)
+{
+    for (size_t i = 0; i < count; i++)
+        memcpy(dest + i * 4, &lut[indices[i]], 4);
+}
+
+#ifdef ROTOOLS_PALLUT_X86
+
+__attribute__((target("avx2")))
+void expandAvx2(const uint32_t* lut, const uint8_t* indices, size_t count, uint8_t* dest)
+{
+    const int* table = reinterpret_cast<const int*>(lut);
+    size_t i = 0;
+
+    // 16 indices at a time, as two gathers of 8 pixels
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i));
+        const __m256i low = _mm256_cvtepu8_epi32(block);
+        const __m256i high = _mm256_cvtepu8_epi32(_mm_srli_si128(block, 8));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * 4), _mm256_i32gather_epi32(table, low, 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * 4 + 32), _mm256_i32gather_epi32(table, high, 4));
+    }
+
+    expandScalar(lut, indices + i, count - i, dest + i * 4);
+}
+
+#endif // ROTOOLS_PALLUT_X86
+
+ExpandFunction selectExpand()
+{
+#ifdef ROTOOLS_PALLUT_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+        return expandAvx2;
+#endif
+
+    return expandScalar;
+}
+
+} // namespace
+
+PalLut::PalLut(const Pal& pal, Alpha alpha) noexcept
+{
+    // First palette color is the transparency color
+    const Color& transp_color = pal.colors[0];
+
+    for (size_t i = 0; i < entries_.size(); i++)
+    {
+        Color color = pal.colors[i];
+
+        if (alpha == Opaque) {
+            color.a = 255;
+        }
+        else if (alpha == KeyedFirstColor) {
+            color.a = (color.r == transp_color.r && color.g == transp_color.g && color.b == transp_color.b) ? 0 : 255;
+        }
+
+        memcpy(&entries_[i], &color, sizeof(color));
+    }
+}
+
+void PalLut::expand(const uint8_t* indices, size_t count, uint8_t* dest) const noexcept
+{
+    static const ExpandFunction expand_function = selectExpand();
+    expand_function(entries_.data(), indices, count, dest);
+}
+
+} // namespace format
@@ -0,0 +1,44 @@
+#ifndef ROTOOLS_FORMAT_PALLUT_HPP
+#define ROTOOLS_FORMAT_PALLUT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "Pal.hpp"
+
+namespace format {
+
+/**
+ * Lookup table expanding palette indices into RGBA pixels.
+ *
+ * Each palette color is packed into 4 bytes, in r, g, b, a order, with its
+ * alpha already decided, so expanding is a single table lookup per pixel.
+ * Expansion is vectorized with AVX2 gathers if the CPU supports them.
+ */
+class PalLut final {
+public:
+    enum Alpha {
+        Opaque,          // every color is opaque
+        KeyedFirstColor, // colors with the first color's rgb are transparent, others opaque
+        PalAlpha         // alpha is taken from the palette
+    };
+
+    /// Builds the table of a palette.
+    explicit PalLut(const Pal& pal, Alpha alpha = KeyedFirstColor) noexcept;
+
+    /// Expands count indices into count RGBA pixels at dest, which must hold count * 4 bytes.
+    void expand(const uint8_t* indices, size_t count, uint8_t* dest) const noexcept;
+
+    /// Packed color of an index.
+    uint32_t operator[](uint8_t index) const noexcept { return entries_[index]; }
+
+    /// The 256 packed colors, in index order.
+    const uint32_t* data() const noexcept { return entries_.data(); }
+
+private:
+    alignas(32) std::array<uint32_t, 256> entries_;
+};
+
+} // namespace format
+
+#endif // ROTOOLS_FORMAT_PALLUT_HPP
@@ -1,15 +1,16 @@
 #include "Spr.hpp"
 
+#include <algorithm>
 #include <cstring>
-#include <fstream>
 #include <vector>
+#include "ZeroRle.hpp"
 #include "../util/InvalidResource.hpp"
 
 using namespace std;
 
 namespace format {
 
-void Spr::load(const Buffer& buf)
+Spr::Layout Spr::scan(const BufferView& buf)
 try {
     const char spr_magic[] = {'S', 'P'};
     char magic[sizeof(spr_magic)];
@@ -20,10 +21,12 @@ try {
     if (strncmp(magic, spr_magic, sizeof(spr_magic)) != 0)
         throw InvalidResource("spr: invalid magic, expected 'SP'");
 
+    Layout layout;
+
     // Get version
     int hex_version = buf.readUint16();
-    version.major = (hex_version >> 8) & 0xFF;
-    version.minor = hex_version & 0xFF;
+    layout.version.major = (hex_version >> 8) & 0xFF;
+    layout.version.minor = hex_version & 0xFF;
 
     switch (hex_version)
     {
@@ -33,7 +36,7 @@ try {
         case 0x201:
             break; // supported    
         default:
-            throw InvalidResource("spr: unsupported version '" + to_string(version.major) + '.' + to_string(version.minor) + "'");
+            throw InvalidResource("spr: unsupported version '" + to_string(layout.version.major) + '.' + to_string(layout.version.minor) + "'");
     }
 
     // Get palette images count
@@ -42,89 +45,218 @@ try {
     // Get rgba images count if any
     uint16_t rgba_img_count = (hex_version >= 0x200 ? buf.readUint16() : 0);
 
+    layout.palette_images.reserve(pal_img_count);
+    layout.rgba_images.reserve(rgba_img_count);
+
     for (int i = 0; i < pal_img_count; i++)
     {
-        PaletteImage img;
-        img.width = buf.readUint16();
-        img.height = buf.readUint16();
-        const size_t pixel_count = img.width * img.height;
+        ImageInfo info;
+        info.width = buf.readUint16();
+        info.height = buf.readUint16();
+        const size_t pixel_count = static_cast<size_t>(info.width) * info.height;
 
         if (!pixel_count)
             continue; // empty image, skip it
 
-        img.indices.resize(pixel_count);
+        // Encoded data is preceded by its size
+        info.size = (hex_version < 0x201 ? pixel_count : buf.readUint16());
+        info.offset = buf.tell();
+        buf.skip(info.size);
 
-        if (hex_version < 0x201) {
-            // Plain data, just copy
-            buf.read(img.indices.data(), pixel_count);
-        }
-        else
-        {
-            // Decode data
-            unsigned int i = 0;
-            uint16_t encoded = buf.readUint16();
-
-            while (i < pixel_count && encoded > 0)
-            {
-                uint8_t color = buf.readUint8();
-                encoded--;
-
-                if (color == 0)
-                {
-                    // color 0 is rle-encoded (invisible/background palette index)
-                    uint8_t len = buf.readUint8();
-                    encoded--;
-
-                    if (len == 0)
-                        len = 1;
-
-                    if ((i + len) > pixel_count)
-                        throw InvalidResource("spr: too much encoded data for pal image");
-
-                    memset(&img.indices[i], 0, len);
-                    i += len;
-                }
-                else
-                    img.indices[i++] = color;
-            }
-        }
-
-        palette_images.emplace_back(move(img));
+        layout.palette_images.push_back(info);
     }
 
     for (int i = 0; i < rgba_img_count; i++)
     {
-        RgbaImage img;
-        img.width = buf.readUint16();
-        img.height = buf.readUint16();
-        const size_t pixel_count = img.width * img.height;
+        ImageInfo info;
+        info.width = buf.readUint16();
+        info.height = buf.readUint16();
+        const size_t pixel_count = static_cast<size_t>(info.width) * info.height;
 
         if (!pixel_count)
             continue; // empty image, skip it
-        
-        for (int j = 0; j < pixel_count; j++)
-        {
-            Color color;
-            color.r = buf.readUint8();
-            color.g = buf.readUint8();
-            color.b = buf.readUint8();
-            color.a = buf.readUint8();
-            img.pixels.emplace_back(move(color));
-        }
 
-        rgba_images.emplace_back(move(img));
+        info.size = pixel_count * sizeof(Color);
+        info.offset = buf.tell();
+        buf.skip(info.size);
+
+        layout.rgba_images.push_back(info);
     }
 
-    if (hex_version >= 0x101)
-        pal = make_unique<Pal>(buf);
+    return layout;
 }
 catch (const out_of_range&) {
     throw InvalidResource("spr: missing data");
 }
 
+void Spr::readPaletteImage(const BufferView& buf, Version version, const ImageInfo& info, uint8_t* dest)
+{
+    const uint8_t* src = buf.data() + info.offset;
+
+    if (((version.major << 8) | version.minor) < 0x201) {
+        // Plain data, just copy
+        memcpy(dest, src, info.size);
+    }
+    else {
+        decodeZeroRle(src, info.size, dest, static_cast<size_t>(info.width) * info.height);
+    }
+}
+
+Spr::~Spr()
+{
+    // Images may take their data from the arena, so release them first
+    palette_images.clear();
+    rgba_images.clear();
+}
+
+void Spr::load(const BufferView& buf, Allocation allocation)
+{
+    const Layout layout = scan(buf);
+    version = layout.version;
+
+    palette_images.clear();
+    rgba_images.clear();
+    arena_.reset();
+
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource();
+
+    if (allocation == Allocation::Arena)
+    {
+        // Size the arena for every image at once
+        size_t size = 0;
+
+        for (const ImageInfo& info : layout.palette_images)
+            size += static_cast<size_t>(info.width) * info.height;
+
+        for (const ImageInfo& info : layout.rgba_images)
+            size += static_cast<size_t>(info.width) * info.height * sizeof(Color);
+
+        arena_ = make_unique<std::pmr::monotonic_buffer_resource>(max<size_t>(size, 1));
+        resource = arena_.get();
+    }
+
+    palette_images.reserve(layout.palette_images.size());
+    rgba_images.reserve(layout.rgba_images.size());
+
+    for (const ImageInfo& info : layout.palette_images)
+    {
+        PaletteImage& img = palette_images.emplace_back(PaletteImage{ info.width, info.height, std::pmr::vector<uint8_t>(resource) });
+        img.indices.resize(static_cast<size_t>(info.width) * info.height);
+        readPaletteImage(buf, version, info, img.indices.data());
+    }
+
+    for (const ImageInfo& info : layout.rgba_images)
+    {
+        RgbaImage& img = rgba_images.emplace_back(RgbaImage{ info.width, info.height, std::pmr::vector<Color>(resource) });
+        img.pixels.resize(static_cast<size_t>(info.width) * info.height);
+        memcpy(img.pixels.data(), buf.data() + info.offset, info.size);
+    }
+
+    pal.reset();
+
+    if (((version.major << 8) | version.minor) >= 0x101)
+        pal = make_unique<Pal>(buf);
+}
+
 void Spr::save(Buffer& buf) const
 {
+    const int hex_version = (version.major << 8) | version.minor;
+
+    switch (hex_version)
+    {
+        case 0x100:
+        case 0x101:
+        case 0x200:
+        case 0x201:
+            break; // supported
+        default:
+            throw InvalidResource("spr: unsupported version '" + to_string(version.major) + '.' + to_string(version.minor) + "'");
+    }
+
+    if (palette_images.size() > 0xFFFF || rgba_images.size() > 0xFFFF)
+        throw InvalidResource("spr: too many images");
+
+    if (hex_version < 0x200 && !rgba_images.empty())
+        throw InvalidResource("spr: rgba images require version 2.0");
+
+    if (hex_version >= 0x101 && !pal)
+        throw InvalidResource("spr: missing palette");
+
+    // Encoded data is usually smaller than raw, so this is enough most of the time
+    buf.reserve(buf.tell() + serializedSize());
+
+    const char spr_magic[] = {'S', 'P'};
+    buf.write(spr_magic, sizeof(spr_magic));
+    buf.writeUint16(static_cast<uint16_t>(hex_version));
+    buf.writeUint16(static_cast<uint16_t>(palette_images.size()));
+
+    if (hex_version >= 0x200)
+        buf.writeUint16(static_cast<uint16_t>(rgba_images.size()));
+
+    vector<uint8_t> encoded;
+
+    for (const PaletteImage& img : palette_images)
+    {
+        buf.writeUint16(img.width);
+        buf.writeUint16(img.height);
+        const size_t pixel_count = static_cast<size_t>(img.width) * img.height;
+
+        if (!pixel_count)
+            continue;
+
+        if (img.indices.size() != pixel_count)
+            throw InvalidResource("spr: pal image has " + to_string(img.indices.size()) + " indices, expected " + to_string(pixel_count));
+
+        if (hex_version < 0x201) {
+            buf.write(img.indices.data(), pixel_count);
+            continue;
+        }
+
+        encoded.resize(zeroRleBound(pixel_count));
+        const size_t encoded_size = encodeZeroRle(img.indices.data(), pixel_count, encoded.data());
+
+        if (encoded_size > 0xFFFF)
+            throw InvalidResource("spr: encoded pal image takes " + to_string(encoded_size) + " bytes, more than 65535");
+
+        buf.writeUint16(static_cast<uint16_t>(encoded_size));
+        buf.write(encoded.data(), encoded_size);
+    }
+
+    for (const RgbaImage& img : rgba_images)
+    {
+        buf.writeUint16(img.width);
+        buf.writeUint16(img.height);
+        const size_t pixel_count = static_cast<size_t>(img.width) * img.height;
+
+        if (!pixel_count)
+            continue;
+
+        if (img.pixels.size() != pixel_count)
+            throw InvalidResource("spr: rgba image has " + to_string(img.pixels.size()) + " pixels, expected " + to_string(pixel_count));
+
+        buf.writeArray(img.pixels.data(), pixel_count);
+    }
+
+    if (hex_version >= 0x101)
+        pal->save(buf);
+}
+
+size_t Spr::serializedSize() const
+{
+    const int hex_version = (version.major << 8) | version.minor;
+    size_t size = (hex_version >= 0x200 ? 8 : 6);
+
+    // Assume encoded images take as much as raw ones, plus their encoded size
+    for (const PaletteImage& img : palette_images)
+        size += (hex_version >= 0x201 && !img.indices.empty() ? 6 : 4) + img.indices.size();
+
+    for (const RgbaImage& img : rgba_images)
+        size += 4 + img.pixels.size() * sizeof(Color);
+
+    if (hex_version >= 0x101 && pal)
+        size += pal->serializedSize();
 
+    return size;
 }
 
 } // namespace format
\ No newline at end of file
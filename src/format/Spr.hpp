@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <memory_resource>
 #include <vector>
 #include <string>
 #include "Pal.hpp"
@@ -11,39 +12,102 @@
 
 namespace format {
 
+/**
+ * Sprite image collection.
+ *
+ * Each image owns its data, sized up front from the image headers when
+ * loading. Loading with Allocation::Arena instead takes the data of every
+ * image from one block owned by the Spr, making a handful of allocations
+ * per file instead of one per image; images must then not outlive the Spr.
+ */
 struct Spr {
+    struct Version {
+        uint8_t major;
+        uint8_t minor;
+    };
+
     struct PaletteImage {
         unsigned short width;
         unsigned short height;
-        std::vector<uint8_t> indices;
+        std::pmr::vector<uint8_t> indices;
     };
 
     struct RgbaImage {
         unsigned short width;
         unsigned short height;
-        std::vector<Color> pixels;
+        std::pmr::vector<Color> pixels;
+    };
+
+    /// Location of an image's data in a spr file.
+    struct ImageInfo {
+        unsigned short width;
+        unsigned short height;
+        size_t offset;  // offset of the image's data
+        size_t size;    // size of the image's data, encoded or not
+    };
+
+    /// Version and image locations of a spr file.
+    struct Layout {
+        Version version;
+        std::vector<ImageInfo> palette_images;
+        std::vector<ImageInfo> rgba_images;
+    };
+
+    /**
+     * Reads a spr file's headers without decoding any image, leaving buf's
+     * cursor at the palette. Empty images are skipped.
+     *
+     * @throws InvalidResource on failure.
+     */
+    static Layout scan(const BufferView& buf);
+
+    /**
+     * Reads a scanned palette image into dest, which must hold width * height bytes.
+     *
+     * @throws InvalidResource if the image data is invalid.
+     */
+    static void readPaletteImage(const BufferView& buf, Version version, const ImageInfo& info, uint8_t* dest);
+
+    /// Where load() allocates image data.
+    enum class Allocation {
+        PerImage, // each image from the heap
+        Arena     // every image from one block owned by the Spr
     };
 
     /// Constructs an empty Spr.
     explicit Spr() = default;
 
     /// Constructs and loads from memory buffer.
-    explicit Spr(const Buffer& buf) { load(buf); }
+    explicit Spr(const BufferView& buf, Allocation allocation = Allocation::PerImage) { load(buf, allocation); }
+
+    Spr(Spr&&) = default;
+    Spr& operator=(Spr&&) = default;
+    ~Spr();
 
     /**
      * Loads from memory buffer.
      *
      * @throws InvalidResource on failure.
      */
-    void load(const Buffer& buf);
+    void load(const BufferView& buf, Allocation allocation = Allocation::PerImage);
 
-    /// Saves to memory buffer.
+    /**
+     * Saves to memory buffer, encoding palette images if version is 2.1.
+     *
+     * @throws InvalidResource if the version is unsupported or an image cannot be stored by it.
+     */
     void save(Buffer& buf) const;
 
-    struct { uint8_t major, minor; } version;
+    /// Number of bytes written by save(), an estimate if palette images are encoded.
+    size_t serializedSize() const;
+
+    Version version;
     std::vector<PaletteImage> palette_images;
     std::vector<RgbaImage> rgba_images;
     std::unique_ptr<Pal> pal;
+
+private:
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena_; // if loaded with Allocation::Arena
 };
 
 } // namespace format
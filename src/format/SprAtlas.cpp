@@ -0,0 +1,86 @@
+#include "SprAtlas.hpp"
+
+#include <algorithm>
+#include <future>
+
+using namespace std;
+
+namespace format {
+
+SprAtlas::SprAtlas(const Spr& spr, unsigned int max_width)
+    : spr_{ spr }
+{
+    regions_.reserve(spr.palette_images.size());
+
+    unsigned int x = 0;
+    unsigned int y = 0;
+    unsigned int row_height = 0;
+
+    for (const Spr::PaletteImage& img : spr.palette_images)
+    {
+        // Start a new row if the image doesn't fit in the current one
+        if (x > 0 && x + img.width > max_width)
+        {
+            x = 0;
+            y += row_height;
+            row_height = 0;
+        }
+
+        regions_.push_back({ x, y, img.width, img.height });
+
+        x += img.width;
+        row_height = max<unsigned int>(row_height, img.height);
+        width_ = max(width_, x);
+    }
+
+    height_ = y + row_height;
+}
+
+void SprAtlas::render(const PalLut& lut, uint8_t* dest) const noexcept
+{
+    const size_t stride = static_cast<size_t>(width_) * 4;
+
+    for (size_t i = 0; i < regions_.size(); i++)
+    {
+        const Region& region = regions_[i];
+        const uint8_t* indices = spr_.palette_images[i].indices.data();
+        uint8_t* row = dest + region.y * stride + static_cast<size_t>(region.x) * 4;
+
+        for (unsigned int y = 0; y < region.height; y++)
+        {
+            lut.expand(indices, region.width, row);
+            indices += region.width;
+            row += stride;
+        }
+    }
+}
+
+vector<uint8_t> SprAtlas::render(const Pal& pal, PalLut::Alpha alpha) const
+{
+    vector<uint8_t> pixels(static_cast<size_t>(width_) * height_ * 4);
+    render(PalLut(pal, alpha), pixels.data());
+    return pixels;
+}
+
+void SprAtlas::renderEach(const vector<Pal>& pals, PalLut::Alpha alpha, ThreadPool& pool,
+                          const function<void(size_t index, const vector<uint8_t>& pixels)>& sink) const
+{
+    vector<future<void>> results;
+    results.reserve(pals.size());
+
+    for (size_t i = 0; i < pals.size(); i++)
+    {
+        results.push_back(pool.submit([this, &pals, alpha, &sink, i] {
+            sink(i, render(pals[i], alpha));
+        }));
+    }
+
+    // Let every palette finish before rethrowing
+    for (future<void>& result : results)
+        result.wait();
+
+    for (future<void>& result : results)
+        result.get();
+}
+
+} // namespace format
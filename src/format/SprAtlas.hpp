@@ -0,0 +1,66 @@
+#ifndef ROTOOLS_FORMAT_SPRATLAS_HPP
+#define ROTOOLS_FORMAT_SPRATLAS_HPP
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "Pal.hpp"
+#include "PalLut.hpp"
+#include "Spr.hpp"
+#include "../util/ThreadPool.hpp"
+
+namespace format {
+
+/**
+ * Palette images of a spr packed into a single RGBA image, which may be
+ * rendered with any number of palettes.
+ *
+ * Images are packed in rows once, so each recolor only expands the spr's
+ * indices through the palette's lookup table. The spr must outlive the atlas.
+ */
+class SprAtlas final {
+public:
+    /// Where an image is in the atlas.
+    struct Region {
+        unsigned int x;
+        unsigned int y;
+        unsigned short width;
+        unsigned short height;
+    };
+
+    /// Packs every palette image of spr in rows no wider than max_width, unless an image is wider.
+    explicit SprAtlas(const Spr& spr, unsigned int max_width = 2048);
+
+    unsigned int width() const noexcept { return width_; }
+    unsigned int height() const noexcept { return height_; }
+
+    /// Regions of each palette image, in the spr's order.
+    const std::vector<Region>& regions() const noexcept { return regions_; }
+
+    /// Renders with a palette into dest, which must hold width() * height() * 4 bytes. Space between images is left untouched.
+    void render(const PalLut& lut, uint8_t* dest) const noexcept;
+
+    /// Renders with a palette, leaving space between images transparent.
+    std::vector<uint8_t> render(const Pal& pal, PalLut::Alpha alpha = PalLut::KeyedFirstColor) const;
+
+    /**
+     * Renders once per palette on a thread pool, passing each result to sink
+     * as soon as it's ready. sink is called from the pool's threads, possibly
+     * concurrently, and only one atlas per thread is held at a time. Must not
+     * be called from the pool's threads.
+     *
+     * @throws The first exception thrown by sink, once every palette is done.
+     */
+    void renderEach(const std::vector<Pal>& pals, PalLut::Alpha alpha, ThreadPool& pool,
+                    const std::function<void(size_t index, const std::vector<uint8_t>& pixels)>& sink) const;
+
+private:
+    const Spr& spr_;
+    std::vector<Region> regions_;
+    unsigned int width_ = 0;
+    unsigned int height_ = 0;
+};
+
+} // namespace format
+
+#endif // ROTOOLS_FORMAT_SPRATLAS_HPP
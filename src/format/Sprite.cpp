@@ -1,76 +1,232 @@
 #include "Sprite.hpp"
 
+#include <string>
+#include "SpriteRecords.hpp"
+#include "ZeroRle.hpp"
 #include "../util/InvalidResource.hpp"
 
 using namespace std;
 
 namespace format {
 
-void Sprite::load(const Buffer& buf)
+using namespace sprite_records;
+
+/// Reads frame records, whose layout is the same in both versions.
+static void readFrames(const BufferView& buf, vector<Sprite::Frame>& frames)
+{
+    for (Sprite::Frame& frame : frames)
+    {
+        // Layers, checking all layer records and the frame trailer are present before reading them
+        frame.layers.resize(buf.readUint8());
+        buf.require(frame.layers.size() * layer_record_size + frame_trailer_size);
+
+        for (Sprite::Layer& layer : frame.layers)
+        {
+            layer.image_index = buf.getUint8();
+            layer.x = buf.getInt16();
+            layer.y = buf.getInt16();
+            layer.rotation = buf.getUint16();
+            // scale_x
+            // scale_y
+            buf.getArray(&layer.color, 1);
+            layer.mirror = buf.getUint8();
+        }
+
+        frame.anchor_x = buf.getInt16();
+        frame.anchor_y = buf.getInt16();
+        frame.sound_index = buf.getInt8();
+    }
+}
+
+static void writeFrames(Buffer& buf, const vector<Sprite::Frame>& frames)
+{
+    for (const Sprite::Frame& frame : frames)
+    {
+        if (frame.layers.size() > 0xFF)
+            throw InvalidResource("sprite: too many layers in a frame");
+
+        // Layers
+        buf.writeUint8(static_cast<uint8_t>(frame.layers.size()));
+
+        for (const Sprite::Layer& layer : frame.layers)
+        {
+            buf.writeUint8(layer.image_index);
+            buf.writeInt16(layer.x);
+            buf.writeInt16(layer.y);
+            buf.writeUint16(layer.rotation);
+            // scale_x
+            // scale_y
+            buf.writeArray(&layer.color, 1);
+            buf.writeUint8(layer.mirror);
+        }
+
+        buf.writeInt16(frame.anchor_x);
+        buf.writeInt16(frame.anchor_y);
+        buf.writeInt8(frame.sound_index);
+    }
+}
+
+void Sprite::load(const BufferView& buf)
 try {
+    const Index index = readIndex(buf);
+    version = index.version;
+
     // Palette
+    buf.seek(index.palette_offset);
     pal.load(buf);
 
     // Images
-    images.resize(buf.readUint8());
+    images.resize(index.image_offsets.size());
 
-    for (Image& image : images)
-    {
-        image.width = buf.readUint16();
-        image.height = buf.readUint16();
-        const size_t index_count = image.width * image.height;
-
-        if (!index_count)
-            continue;
-        
-        image.indices.resize(index_count);
-        buf.read(image.indices.data(), image.indices.size());
-    }
+    for (size_t i = 0; i < images.size(); i++)
+        readImage(buf, version, index.image_offsets[i], images[i]);
 
     // Sounds
-    sounds.resize(buf.readUint8());
+    buf.seek(index.sounds_offset);
+    sounds.resize(index.sound_count);
+    buf.readArray(sounds.data(), sounds.size());
 
     for (Sound& sound : sounds)
-    {
-        buf.read(sound.filename.data(), sound.filename.size());
         sound.filename[39] = '\0';
-    }
 
     // Animations
-    animations.resize(buf.readUint8());
+    animations.resize(index.animation_offsets.size());
+
+    for (size_t i = 0; i < animations.size(); i++)
+        readAnimation(buf, version, index.animation_offsets[i], animations[i]);
+}
+catch (const out_of_range&) {
+    throw InvalidResource("sprite: missing data");
+}
 
-    for (Animation& anim : animations)
+Sprite::Index Sprite::readIndex(const BufferView& buf)
+try {
+    const size_t base = buf.tell();
+    Index index;
+
+    if (!hasMagic(buf))
     {
-        anim.delay = buf.readUint16();
-        
-        // Frames
-        anim.frames.resize(buf.readUint8());
+        // Version 1 has no index, so find records by skipping over them
+        index.version = 1;
+        index.palette_offset = base;
+        buf.skip(sizeof(Pal::colors));
+
+        index.image_offsets.resize(buf.readUint8());
 
-        for (Frame& frame : anim.frames)
+        for (size_t& offset : index.image_offsets)
         {
-            // Layers
-            frame.layers.resize(buf.readUint8());
-
-            for (Layer& layer : frame.layers)
-            {
-                layer.image_index = buf.readUint8();
-                layer.x = buf.readInt16();
-                layer.y = buf.readInt16();
-                layer.rotation = buf.readUint16();
-                // scale_x
-                // scale_y
-                layer.color.r = buf.readUint8();
-                layer.color.g = buf.readUint8();
-                layer.color.b = buf.readUint8();
-                layer.color.a = buf.readUint8();
-                layer.mirror = buf.readUint8();
-            }
-
-            frame.anchor_x = buf.readInt16();
-            frame.anchor_y = buf.readInt16();
-            frame.sound_index = buf.readInt8();
+            offset = buf.tell();
+            const size_t width = buf.readUint16();
+            const size_t height = buf.readUint16();
+            buf.skip(width * height);
         }
+
+        index.sound_count = buf.readUint8();
+        index.sounds_offset = buf.tell();
+        buf.skip(index.sound_count * sizeof(Sound));
+
+        index.animation_offsets.resize(buf.readUint8());
+
+        for (size_t& offset : index.animation_offsets)
+        {
+            offset = buf.tell();
+            buf.skip(2); // delay
+            skipFrames(buf, buf.readUint8());
+        }
+
+        return index;
+    }
+
+    buf.skip(sizeof(magic));
+    index.version = buf.readUint16();
+
+    // Check version
+    if (index.version != 2)
+        throw InvalidResource("sprite: unsupported version '" + to_string(index.version) + "'");
+
+    buf.require(3 * 2);
+    index.image_offsets.resize(buf.getUint16());
+    index.sound_count = buf.getUint16();
+    index.animation_offsets.resize(buf.getUint16());
+
+    index.palette_offset = buf.tell();
+    buf.skip(sizeof(Pal::colors));
+
+    // Offset tables, relative to the start of the file
+    buf.require((index.image_offsets.size() + index.animation_offsets.size()) * 4);
+
+    for (size_t& offset : index.image_offsets)
+        offset = base + buf.getUint32();
+
+    for (size_t& offset : index.animation_offsets)
+        offset = base + buf.getUint32();
+
+    index.sounds_offset = buf.tell();
+    buf.skip(index.sound_count * sizeof(Sound));
+
+    return index;
+}
+catch (const out_of_range&) {
+    throw InvalidResource("sprite: missing data");
+}
+
+void Sprite::readImage(const BufferView& buf, uint16_t version, size_t offset, Image& image)
+try {
+    buf.seek(offset);
+
+    image.width = buf.readUint16();
+    image.height = buf.readUint16();
+    const size_t index_count = static_cast<size_t>(image.width) * image.height;
+
+    if (version == 1)
+    {
+        image.indices.resize(index_count);
+
+        if (index_count)
+            buf.read(image.indices.data(), image.indices.size());
+
+        return;
+    }
+
+    const uint8_t compression = buf.readUint8();
+    const size_t data_size = buf.readUint32();
+    buf.require(data_size);
+
+    const uint8_t* data = buf.data() + buf.tell();
+
+    switch (compression)
+    {
+        case compression_none:
+            if (data_size != index_count)
+                throw InvalidResource("sprite: image has " + to_string(data_size) + " indices, expected " + to_string(index_count));
+
+            image.indices.assign(data, data + index_count);
+            break;
+
+        case compression_zero_rle:
+            // Indices not covered by the data are left 0
+            image.indices.assign(index_count, 0);
+            decodeZeroRle(data, data_size, image.indices.data(), image.indices.size());
+            break;
+
+        default:
+            throw InvalidResource("sprite: unknown image compression '" + to_string(compression) + "'");
     }
+
+    buf.skip(data_size);
+}
+catch (const out_of_range&) {
+    throw InvalidResource("sprite: missing data");
+}
+
+void Sprite::readAnimation(const BufferView& buf, uint16_t version, size_t offset, Animation& anim)
+try {
+    buf.seek(offset);
+
+    anim.delay = buf.readUint16();
+    anim.frames.resize(version == 1 ? buf.readUint8() : buf.readUint16());
+
+    readFrames(buf, anim.frames);
 }
 catch (const out_of_range&) {
     throw InvalidResource("sprite: missing data");
@@ -78,66 +234,178 @@ catch (const out_of_range&) {
 
 void Sprite::save(Buffer& buf) const
 {
+    if (version != 1 && version != 2)
+        throw InvalidResource("sprite: unsupported version '" + to_string(version) + "'");
+
+    const size_t max_count = (version == 1 ? 0xFF : 0xFFFF);
+
+    if (images.size() > max_count)
+        throw InvalidResource("sprite: too many images");
+
+    if (sounds.size() > max_count)
+        throw InvalidResource("sprite: too many sounds");
+
+    if (animations.size() > max_count)
+        throw InvalidResource("sprite: too many animations");
+
+    // Allocate everything up front so the writes below never reallocate
+    buf.reserve(buf.tell() + serializedSize());
+
+    if (version == 1)
+    {
+        // Palette
+        pal.save(buf);
+
+        // Images
+        buf.writeUint8(static_cast<uint8_t>(images.size()));
+
+        for (const Image& image : images)
+        {
+            buf.writeUint16(image.width);
+            buf.writeUint16(image.height);
+            const size_t index_count = static_cast<size_t>(image.width) * image.height;
+
+            if (image.indices.size() != index_count)
+                throw InvalidResource("sprite: image has " + to_string(image.indices.size()) + " indices, expected " + to_string(index_count));
+
+            if (index_count)
+                buf.write(image.indices.data(), index_count);
+        }
+
+        // Sounds
+        buf.writeUint8(static_cast<uint8_t>(sounds.size()));
+        buf.writeArray(sounds.data(), sounds.size());
+
+        // Animations
+        buf.writeUint8(static_cast<uint8_t>(animations.size()));
+
+        for (const Animation& anim : animations)
+        {
+            if (anim.frames.size() > 0xFF)
+                throw InvalidResource("sprite: too many frames in an animation");
+
+            buf.writeUint16(anim.delay);
+            buf.writeUint8(static_cast<uint8_t>(anim.frames.size()));
+            writeFrames(buf, anim.frames);
+        }
+
+        return;
+    }
+
+    const size_t base = buf.tell();
+
+    // Header
+    buf.write(magic, sizeof(magic));
+    buf.writeUint16(version);
+    buf.writeUint16(static_cast<uint16_t>(images.size()));
+    buf.writeUint16(static_cast<uint16_t>(sounds.size()));
+    buf.writeUint16(static_cast<uint16_t>(animations.size()));
+
     // Palette
     pal.save(buf);
 
-    // Images
-    buf.writeUint8(static_cast<uint8_t>(images.size()));
+    // Offset tables, filled in once records are written
+    const size_t tables_offset = buf.tell();
+
+    for (size_t i = 0; i < images.size() + animations.size(); i++)
+        buf.writeUint32(0);
+
+    // Sounds
+    buf.writeArray(sounds.data(), sounds.size());
+
+    // Images, each compressed if that makes it smaller
+    vector<uint32_t> offsets;
+    offsets.reserve(images.size() + animations.size());
+
+    vector<uint8_t> encoded;
 
     for (const Image& image : images)
     {
+        const size_t index_count = static_cast<size_t>(image.width) * image.height;
+
+        if (image.indices.size() != index_count)
+            throw InvalidResource("sprite: image has " + to_string(image.indices.size()) + " indices, expected " + to_string(index_count));
+
+        offsets.push_back(static_cast<uint32_t>(buf.tell() - base));
+
+        encoded.resize(zeroRleBound(index_count));
+        const size_t encoded_size = encodeZeroRle(image.indices.data(), index_count, encoded.data());
+        const bool compress = (encoded_size < index_count);
+
         buf.writeUint16(image.width);
         buf.writeUint16(image.height);
-        const size_t index_count = image.width * image.height;
+        buf.writeUint8(compress ? compression_zero_rle : compression_none);
 
-        // TODO: should throw or log it?
-        if (!index_count)// || index_count != image.indices.size())
-            continue;
+        if (compress)
+        {
+            buf.writeUint32(static_cast<uint32_t>(encoded_size));
+            buf.write(encoded.data(), encoded_size);
+        }
+        else
+        {
+            buf.writeUint32(static_cast<uint32_t>(index_count));
 
-        buf.write(image.indices.data(), image.indices.size());
+            if (index_count)
+                buf.write(image.indices.data(), index_count);
+        }
     }
 
-    // Sounds
-    buf.writeUint8(static_cast<uint8_t>(sounds.size()));
+    // Animations
+    for (const Animation& anim : animations)
+    {
+        if (anim.frames.size() > 0xFFFF)
+            throw InvalidResource("sprite: too many frames in an animation");
 
-    for (const Sound& sound : sounds)
-        buf.write(sound.filename.data(), sound.filename.size());
+        offsets.push_back(static_cast<uint32_t>(buf.tell() - base));
 
-    // Animations
-    buf.writeUint8(static_cast<uint8_t>(animations.size()));
+        buf.writeUint16(anim.delay);
+        buf.writeUint16(static_cast<uint16_t>(anim.frames.size()));
+        writeFrames(buf, anim.frames);
+    }
+
+    // Go back to fill in the offset tables
+    const size_t end = buf.tell();
+    buf.seek(tables_offset);
+
+    for (uint32_t offset : offsets)
+        buf.setUint32(offset);
 
+    buf.seek(end);
+}
+
+size_t Sprite::serializedSize() const
+{
+    size_t size = pal.serializedSize();
+
+    // Header and offset tables, or counts
+    if (version == 2)
+        size += v2_header_size + (images.size() + animations.size()) * 4;
+    else
+        size += 3;
+
+    // Images
+    for (const Image& image : images)
+    {
+        const size_t index_count = static_cast<size_t>(image.width) * image.height;
+        size += (version == 2 ? v2_image_header_size : 4);
+
+        if (index_count)
+            size += image.indices.size();
+    }
+
+    // Sounds
+    size += sounds.size() * sizeof(Sound);
+
+    // Animations
     for (const Animation& anim : animations)
     {
-        buf.writeUint16(anim.delay);
-        
-        // Frames
-        buf.writeUint8(static_cast<uint8_t>(anim.frames.size()));
+        size += (version == 2 ? 4 : 3);
 
         for (const Frame& frame : anim.frames)
-        {
-            // Layers
-            buf.writeUint8(static_cast<uint8_t>(frame.layers.size()));
-
-            for (const Layer& layer : frame.layers)
-            {
-                buf.writeUint8(layer.image_index);
-                buf.writeInt16(layer.x);
-                buf.writeInt16(layer.y);
-                buf.writeUint16(layer.rotation);
-                // scale_x
-                // scale_y
-                buf.writeUint8(layer.color.r);
-                buf.writeUint8(layer.color.g);
-                buf.writeUint8(layer.color.b);
-                buf.writeUint8(layer.color.a);
-                buf.writeUint8(layer.mirror);
-            }
-
-            buf.writeInt16(frame.anchor_x);
-            buf.writeInt16(frame.anchor_y);
-            buf.writeInt8(frame.sound_index);
-        }
+            size += 1 + frame.layers.size() * layer_record_size + frame_trailer_size;
     }
+
+    return size;
 }
 
-} // namespace format
\ No newline at end of file
+} // namespace format
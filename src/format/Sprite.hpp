@@ -9,6 +9,14 @@
 
 namespace format {
 
+/**
+ * Apollo sprite, a palette, its images and their animations in one file.
+ *
+ * Version 1 stores records back to back, with raw indices. Version 2 adds
+ * a magic, tables with the offset of every image and animation, and
+ * per-image compression, so any record may be read without parsing the
+ * ones before it. See doc/sprite_format_structure.txt.
+ */
 struct Sprite {
     struct Image {
         uint16_t width;
@@ -43,12 +51,60 @@ struct Sprite {
         std::array<char, 40> filename;
     };
 
+    /// Where the records of a file are, relative to the start of its view.
+    struct Index {
+        uint16_t version;
+        size_t palette_offset;
+        size_t sounds_offset;
+        size_t sound_count;
+        std::vector<size_t> image_offsets;
+        std::vector<size_t> animation_offsets;
+    };
+
     explicit Sprite() = default;
-    explicit Sprite(const Buffer& buf) { load(buf); }
+    explicit Sprite(const BufferView& buf) { load(buf); }
 
-    void load(const Buffer& buf);
+    /**
+     * Loads from memory buffer, in either version.
+     *
+     * @throws InvalidResource on failure.
+     */
+    void load(const BufferView& buf);
+
+    /**
+     * Saves to memory buffer in the version set in version.
+     *
+     * @throws InvalidResource if version is unsupported or counts don't fit it.
+     */
     void save(Buffer& buf) const;
 
+    /// Number of bytes written by save(), an upper bound for version 2.
+    size_t serializedSize() const;
+
+    /**
+     * Finds every record of a file starting at buf's cursor. Version 2
+     * files store it in their header, while version 1 files are scanned,
+     * skipping over image data.
+     *
+     * @throws InvalidResource on failure.
+     */
+    static Index readIndex(const BufferView& buf);
+
+    /**
+     * Reads the image at offset, taken from an index of buf.
+     *
+     * @throws InvalidResource on failure.
+     */
+    static void readImage(const BufferView& buf, uint16_t version, size_t offset, Image& image);
+
+    /**
+     * Reads the animation at offset, taken from an index of buf.
+     *
+     * @throws InvalidResource on failure.
+     */
+    static void readAnimation(const BufferView& buf, uint16_t version, size_t offset, Animation& anim);
+
+    uint16_t version = 1; // 1 for the original layout, 2 for the indexed and compressed one
     Pal pal;
     std::vector<Image> images;
     std::vector<Sound> sounds;
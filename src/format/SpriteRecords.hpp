@@ -0,0 +1,59 @@
+#ifndef ROTOOLS_FORMAT_SPRITERECORDS_HPP
+#define ROTOOLS_FORMAT_SPRITERECORDS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "../util/BufferView.hpp"
+
+// Sprite record layout shared by Sprite and SpriteView. Internal to the format library.
+
+namespace format {
+namespace sprite_records {
+
+/// Size of a layer record in the file.
+constexpr size_t layer_record_size = 12;
+
+/// Size of the anchor and sound index ending a frame record.
+constexpr size_t frame_trailer_size = 5;
+
+/// Size of a sound record.
+constexpr size_t sound_record_size = 40;
+
+constexpr char magic[] = {'A', 'S', 'P', 'R'};
+
+/// Size of the version 2 header: magic, version and image, sound and animation counts.
+constexpr size_t v2_header_size = sizeof(magic) + 2 + 3 * 2;
+
+/// Size of a version 2 image record before its data: width, height, compression and data size.
+constexpr size_t v2_image_header_size = 9;
+
+// Compression of version 2 image data
+constexpr uint8_t compression_none = 0;
+constexpr uint8_t compression_zero_rle = 1;
+
+/// Whether buf's cursor is at the magic of version 2 and later files, which version 1 files lack.
+inline bool hasMagic(const BufferView& buf)
+{
+    return buf.remaining() >= sizeof(magic)
+        && std::memcmp(buf.data() + buf.tell(), magic, sizeof(magic)) == 0;
+}
+
+/**
+ * Skips frame records without reading them.
+ *
+ * @throws std::out_of_range if data is missing.
+ */
+inline void skipFrames(const BufferView& buf, size_t frame_count)
+{
+    for (size_t i = 0; i < frame_count; i++)
+    {
+        const size_t layer_count = buf.readUint8();
+        buf.skip(layer_count * layer_record_size + frame_trailer_size);
+    }
+}
+
+} // namespace sprite_records
+} // namespace format
+
+#endif // ROTOOLS_FORMAT_SPRITERECORDS_HPP
@@ -0,0 +1,213 @@
+#include "SpriteView.hpp"
+
+#include <algorithm>
+#include "SpriteRecords.hpp"
+#include "ZeroRle.hpp"
+#include "../util/InvalidResource.hpp"
+
+using namespace std;
+
+namespace format {
+
+using namespace sprite_records;
+
+static_assert(sizeof(SpriteView::Layer) == layer_record_size, "layer size doesn't match its record");
+
+void SpriteView::Image::decode(uint8_t* dest) const
+{
+    const size_t index_count = static_cast<size_t>(width) * height;
+
+    if (!compressed) {
+        copy(data.begin(), data.end(), dest);
+        return;
+    }
+
+    // Indices not covered by the data are left 0
+    fill(dest, dest + index_count, 0);
+    decodeZeroRle(data.data(), data.size(), dest, index_count);
+}
+
+void SpriteView::open(const char* filename)
+{
+    MappedFile file(filename);
+    load(file);
+    file_ = move(file);
+}
+
+void SpriteView::load(const BufferView& buf)
+try {
+    // Offsets are relative to the start of the file
+    data_ = BufferView(buf.data() + buf.tell(), buf.remaining());
+
+    if (!hasMagic(data_))
+    {
+        version = 1;
+        pal.load(data_);
+
+        // Images
+        image_count_ = data_.readUint8();
+        images_offset_ = data_.tell();
+
+        for (size_t i = 0; i < image_count_; i++)
+        {
+            const size_t width = data_.readUint16();
+            const size_t height = data_.readUint16();
+            data_.skip(width * height);
+        }
+
+        // Sounds
+        sound_count_ = data_.readUint8();
+        sounds_offset_ = data_.tell();
+        data_.skip(sound_count_ * sound_record_size);
+
+        // Animations
+        animation_count_ = data_.readUint8();
+        animations_offset_ = data_.tell();
+
+        for (size_t i = 0; i < animation_count_; i++)
+        {
+            data_.skip(2); // delay
+            skipFrames(data_, data_.readUint8());
+        }
+
+        return;
+    }
+
+    data_.skip(sizeof(magic));
+    version = data_.readUint16();
+
+    // Check version
+    if (version != 2)
+        throw InvalidResource("sprite: unsupported version '" + to_string(version) + "'");
+
+    image_count_ = data_.readUint16();
+    sound_count_ = data_.readUint16();
+    animation_count_ = data_.readUint16();
+
+    pal.load(data_);
+
+    // Offset tables
+    images_offset_ = data_.tell();
+    animations_offset_ = images_offset_ + image_count_ * 4;
+    data_.skip((image_count_ + animation_count_) * 4);
+
+    // Sounds
+    sounds_offset_ = data_.tell();
+    data_.skip(sound_count_ * sound_record_size);
+
+    // Images
+    for (size_t i = 0; i < image_count_; i++)
+    {
+        data_.seek(at<uint32_t>(images_offset_ + i * 4));
+
+        const size_t width = data_.readUint16();
+        const size_t height = data_.readUint16();
+        const size_t index_count = width * height;
+        const uint8_t compression = data_.readUint8();
+        const size_t data_size = data_.readUint32();
+
+        if (compression != compression_none && compression != compression_zero_rle)
+            throw InvalidResource("sprite: unknown image compression '" + to_string(compression) + "'");
+
+        if (compression == compression_none && data_size != index_count)
+            throw InvalidResource("sprite: image has " + to_string(data_size) + " indices, expected " + to_string(index_count));
+
+        data_.skip(data_size);
+    }
+
+    // Animations
+    for (size_t i = 0; i < animation_count_; i++)
+    {
+        data_.seek(at<uint32_t>(animations_offset_ + i * 4));
+        data_.skip(2); // delay
+        skipFrames(data_, data_.readUint16());
+    }
+}
+catch (const out_of_range&) {
+    throw InvalidResource("sprite: missing data");
+}
+
+SpriteView::Image SpriteView::image(size_t index) const noexcept
+{
+    Image image;
+    size_t pos = images_offset_;
+
+    if (version == 1)
+    {
+        // Walk past the images before it
+        for (size_t i = 0; i < index; i++)
+            pos += 4 + static_cast<size_t>(at<uint16_t>(pos)) * at<uint16_t>(pos + 2);
+    }
+    else
+        pos = at<uint32_t>(pos + index * 4);
+
+    image.width = at<uint16_t>(pos);
+    image.height = at<uint16_t>(pos + 2);
+
+    if (version == 1) {
+        image.data = { data_.data() + pos + 4, static_cast<size_t>(image.width) * image.height };
+        return image;
+    }
+
+    image.compressed = (at<uint8_t>(pos + 4) == compression_zero_rle);
+    image.data = { data_.data() + pos + v2_image_header_size, at<uint32_t>(pos + 5) };
+    return image;
+}
+
+string SpriteView::soundFilename(size_t index) const
+{
+    const char* filename = reinterpret_cast<const char*>(data_.data() + sounds_offset_ + index * sound_record_size);
+    return string(filename, strnlen(filename, sound_record_size));
+}
+
+SpriteView::Animation SpriteView::animation(size_t index) const noexcept
+{
+    Animation anim;
+    size_t pos = animations_offset_;
+
+    if (version == 1)
+    {
+        // Walk past the animations before it
+        for (size_t i = 0; i < index; i++)
+        {
+            const size_t frame_count = at<uint8_t>(pos + 2);
+            pos += 3;
+
+            for (size_t j = 0; j < frame_count; j++)
+                pos += 1 + at<uint8_t>(pos) * layer_record_size + frame_trailer_size;
+        }
+
+        anim.delay = at<uint16_t>(pos);
+        anim.frame_count = at<uint8_t>(pos + 2);
+        anim.frames_offset = pos + 3;
+        return anim;
+    }
+
+    pos = at<uint32_t>(pos + index * 4);
+
+    anim.delay = at<uint16_t>(pos);
+    anim.frame_count = at<uint16_t>(pos + 2);
+    anim.frames_offset = pos + 4;
+    return anim;
+}
+
+SpriteView::Frame SpriteView::frame(const Animation& anim, size_t index) const noexcept
+{
+    size_t pos = anim.frames_offset;
+
+    // Walk past the frames before it
+    for (size_t i = 0; i < index; i++)
+        pos += 1 + at<uint8_t>(pos) * layer_record_size + frame_trailer_size;
+
+    const size_t layer_count = at<uint8_t>(pos);
+    const size_t trailer_pos = pos + 1 + layer_count * layer_record_size;
+
+    Frame frame;
+    frame.layers = { reinterpret_cast<const Layer*>(data_.data() + pos + 1), layer_count };
+    frame.anchor_x = at<int16_t>(trailer_pos);
+    frame.anchor_y = at<int16_t>(trailer_pos + 2);
+    frame.sound_index = at<int8_t>(trailer_pos + 4);
+    return frame;
+}
+
+} // namespace format
@@ -0,0 +1,141 @@
+#ifndef ROTOOLS_FORMAT_SPRITEVIEW_HPP
+#define ROTOOLS_FORMAT_SPRITEVIEW_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "Pal.hpp"
+#include "../util/BufferView.hpp"
+#include "../util/Color.hpp"
+#include "../util/MappedFile.hpp"
+#include "../util/Span.hpp"
+
+namespace format {
+
+/**
+ * Read-only Sprite whose records are read in place from its file.
+ *
+ * Loading validates every record once, and then images, frames and layers
+ * are returned as spans into the file, so nothing but the palette is ever
+ * copied and nothing is allocated. Version 1 files have no index, so
+ * reaching image or animation i walks the records before it, which version
+ * 2 files look up in their offset tables instead.
+ */
+class SpriteView final {
+public:
+    /// Layer record as stored in the file, with unaligned fields.
+    class Layer {
+    public:
+        uint8_t imageIndex() const noexcept { return bytes_[0]; }
+        int16_t x() const noexcept { return get<int16_t>(1); }
+        int16_t y() const noexcept { return get<int16_t>(3); }
+        uint16_t rotation() const noexcept { return get<uint16_t>(5); }
+        Color color() const noexcept { return get<Color>(7); }
+        bool mirror() const noexcept { return bytes_[11] != 0; }
+
+    private:
+        template <typename T>
+        T get(size_t pos) const noexcept
+        {
+            T value;
+            std::memcpy(&value, bytes_ + pos, sizeof(T));
+            return value;
+        }
+
+        uint8_t bytes_[12];
+    };
+
+    struct Image {
+        /**
+         * Decodes indices into dest, which must hold width * height bytes.
+         *
+         * @throws InvalidResource if compressed data is invalid.
+         */
+        void decode(uint8_t* dest) const;
+
+        uint16_t width = 0;
+        uint16_t height = 0;
+        bool compressed = false;   // whether data has runs of index 0 encoded as in spr 2.1
+        Span<const uint8_t> data;  // indices, or their encoding if compressed
+    };
+
+    struct Frame {
+        Span<const Layer> layers;
+        int16_t anchor_x = 0;
+        int16_t anchor_y = 0;
+        int8_t sound_index = -1;
+    };
+
+    struct Animation {
+        uint16_t delay = 0;
+        uint16_t frame_count = 0;
+        size_t frames_offset = 0; // of the first frame record
+    };
+
+    /// Constructs an empty SpriteView.
+    explicit SpriteView() = default;
+
+    /// Constructs and opens a sprite file.
+    explicit SpriteView(const char* filename) { open(filename); }
+
+    /**
+     * Maps a sprite file and validates it.
+     *
+     * @throws FileNotOpen if the file cannot be mapped.
+     * @throws InvalidResource if the file is invalid.
+     */
+    void open(const char* filename);
+
+    /**
+     * Validates a sprite in memory starting at buf's cursor, which must
+     * outlive this object.
+     *
+     * @throws InvalidResource on failure.
+     */
+    void load(const BufferView& buf);
+
+    size_t imageCount() const noexcept { return image_count_; }
+    size_t soundCount() const noexcept { return sound_count_; }
+    size_t animationCount() const noexcept { return animation_count_; }
+
+    /// Image at index, which must be less than imageCount().
+    Image image(size_t index) const noexcept;
+
+    /// Sound filename at index, which must be less than soundCount().
+    std::string soundFilename(size_t index) const;
+
+    /// Animation at index, which must be less than animationCount().
+    Animation animation(size_t index) const noexcept;
+
+    /// Frame of anim at index, which must be less than anim.frame_count.
+    Frame frame(const Animation& anim, size_t index) const noexcept;
+
+    uint16_t version = 1;
+    Pal pal;
+
+private:
+    /// Reads a value at pos, which must have been validated.
+    template <typename T>
+    T at(size_t pos) const noexcept
+    {
+        T value;
+        std::memcpy(&value, data_.data() + pos, sizeof(T));
+        return value;
+    }
+
+    MappedFile file_;
+    BufferView data_;
+
+    size_t image_count_ = 0;
+    size_t sound_count_ = 0;
+    size_t animation_count_ = 0;
+
+    // Version 1: first record; version 2: offset table
+    size_t images_offset_ = 0;
+    size_t animations_offset_ = 0;
+    size_t sounds_offset_ = 0;
+};
+
+} // namespace format
+
+#endif // ROTOOLS_FORMAT_SPRITEVIEW_HPP
@@ -31,7 +31,10 @@ static Str::Frame::BlendType blendTypeFromUint(unsigned int value)
     return Str::Frame::Zero;
 }
 
-void Str::load(const Buffer& buf)
+/// Size of a frame record in the file.
+static constexpr size_t frame_record_size = 124;
+
+void Str::load(const BufferView& buf)
 try {
     const char str_magic[] = {'S', 'T', 'R', 'M'};
     constexpr size_t magic_size = sizeof(str_magic);
@@ -51,79 +54,77 @@ try {
     fps = buf.readUint32();
     frame_count = buf.readUint32();
     
-    // Layer count
-    layers.resize(buf.readUint32());
-    
-    buf.skip(16);
+    const uint32_t layer_count = buf.readUint32();
+    buf.read(reserved.data(), reserved.size());
+
+    // Layers, checking each could hold its texture and frame counts before allocating them
+    buf.require(layer_count * size_t(8));
+    layers.resize(layer_count);
 
     for (Layer& layer : layers)
     {
         // Textures
-        layer.textures.resize(buf.readUint32());
+        const uint32_t texture_count = buf.readUint32();
+        buf.require(texture_count * sizeof(Texture));
+        layer.textures.resize(texture_count);
+        buf.getArray(layer.textures.data(), layer.textures.size());
 
         for (Texture& texture : layer.textures)
-        {
-            buf.read(texture.filename.data(), texture.filename.size());
             texture.filename[127] = '\0';
-        }
 
-        // Frames
-        layer.frames.resize(buf.readUint32());
+        // Frames, checking the whole frame array is present before reading it
+        const uint32_t frame_count = buf.readUint32();
+        buf.require(frame_count * frame_record_size);
+        layer.frames.resize(frame_count);
 
         for (Frame& frame : layer.frames)
         {
-            frame.frame_number = buf.readUint32();
-            frame.morph = buf.readUint32() == 1;
-            frame.position.x = buf.readFloat();
-            frame.position.y = buf.readFloat();
+            frame.frame_number = buf.getUint32();
+            frame.morph = buf.getUint32() == 1;
+            frame.position.x = buf.getFloat();
+            frame.position.y = buf.getFloat();
             
-            // First texture uv mapping coordinates
-            float u = buf.readFloat();
-            float v = buf.readFloat();
-            float us = buf.readFloat();
-            float vs = buf.readFloat();
-
-            frame.uv_mapping.a = Point2D(u, v);
-            frame.uv_mapping.b = Point2D(us, v);
-            frame.uv_mapping.c = Point2D(us, vs);
-            frame.uv_mapping.d = Point2D(u, vs);
-
-            // Second texture uv mapping coordinates
-            u = buf.readFloat();
-            v = buf.readFloat();
-            us = buf.readFloat();
-            vs = buf.readFloat();
-
-            frame.uv_mapping2.a = Point2D(u, v);
-            frame.uv_mapping2.b = Point2D(us, v);
-            frame.uv_mapping2.c = Point2D(us, vs);
-            frame.uv_mapping2.d = Point2D(u, vs);
-
-            // Drawing rect positions
-            frame.drawing_rect.a.x = buf.readFloat();
-            frame.drawing_rect.b.x = buf.readFloat();
-            frame.drawing_rect.c.x = buf.readFloat();
-            frame.drawing_rect.d.x = buf.readFloat();
-            frame.drawing_rect.a.y = buf.readFloat();
-            frame.drawing_rect.b.y = buf.readFloat();
-            frame.drawing_rect.c.y = buf.readFloat();
-            frame.drawing_rect.d.y = buf.readFloat();
-
-            frame.texture_index = buf.readUint32(); // float?
-            frame.anitype = buf.readUint32();
-            frame.anidelta = buf.readFloat();
-            frame.rz = buf.readFloat();
+            // First and second texture uv mapping coordinates as u, v, us, vs
+            float uv[8];
+            buf.getArray(uv, 8);
+
+            frame.uv_mapping.a = Point2D(uv[0], uv[1]);
+            frame.uv_mapping.b = Point2D(uv[2], uv[1]);
+            frame.uv_mapping.c = Point2D(uv[2], uv[3]);
+            frame.uv_mapping.d = Point2D(uv[0], uv[3]);
+
+            frame.uv_mapping2.a = Point2D(uv[4], uv[5]);
+            frame.uv_mapping2.b = Point2D(uv[6], uv[5]);
+            frame.uv_mapping2.c = Point2D(uv[6], uv[7]);
+            frame.uv_mapping2.d = Point2D(uv[4], uv[7]);
+
+            // Drawing rect positions as x coordinates followed by y coordinates
+            float xy[8];
+            buf.getArray(xy, 8);
+
+            frame.drawing_rect.a = Point2D(xy[0], xy[4]);
+            frame.drawing_rect.b = Point2D(xy[1], xy[5]);
+            frame.drawing_rect.c = Point2D(xy[2], xy[6]);
+            frame.drawing_rect.d = Point2D(xy[3], xy[7]);
+
+            frame.texture_index = buf.getUint32(); // float?
+            frame.anitype = buf.getUint32();
+            frame.anidelta = buf.getFloat();
+            frame.rz = buf.getFloat();
+
+            float rgba[4];
+            buf.getArray(rgba, 4);
 
             frame.color = Color(
-                static_cast<uint8_t>(buf.readFloat()),
-                static_cast<uint8_t>(buf.readFloat()),
-                static_cast<uint8_t>(buf.readFloat()),
-                static_cast<uint8_t>(buf.readFloat())
+                static_cast<uint8_t>(rgba[0]),
+                static_cast<uint8_t>(rgba[1]),
+                static_cast<uint8_t>(rgba[2]),
+                static_cast<uint8_t>(rgba[3])
             );
 
-            frame.src_blend_type = blendTypeFromUint(buf.readUint32());
-            frame.dest_blend_type = blendTypeFromUint(buf.readUint32());
-            frame.mtpreset = buf.readUint32();
+            frame.src_blend_type = blendTypeFromUint(buf.getUint32());
+            frame.dest_blend_type = blendTypeFromUint(buf.getUint32());
+            frame.mtpreset = buf.getUint32();
         }
     }
 }
@@ -131,4 +132,87 @@ catch (const out_of_range&) {
     throw InvalidResource("str: missing data");
 }
 
+void Str::save(Buffer& buf) const
+{
+    if (version != 148)
+        throw InvalidResource("str: unknown version '" + to_string(version) + '\'');
+
+    // Make room for everything at once, so the writes below never reallocate
+    const size_t size = serializedSize();
+
+    if (size > buf.remaining())
+        buf.grow(size - buf.remaining());
+
+    const char str_magic[] = {'S', 'T', 'R', 'M'};
+    buf.write(str_magic, sizeof(str_magic));
+
+    buf.setUint32(version);
+    buf.setUint32(fps);
+    buf.setUint32(frame_count);
+    buf.setUint32(static_cast<uint32_t>(layers.size()));
+    buf.write(reserved.data(), reserved.size());
+
+    for (const Layer& layer : layers)
+    {
+        // Textures
+        buf.setUint32(static_cast<uint32_t>(layer.textures.size()));
+        buf.writeArray(layer.textures.data(), layer.textures.size());
+
+        // Frames
+        buf.setUint32(static_cast<uint32_t>(layer.frames.size()));
+
+        for (const Frame& frame : layer.frames)
+        {
+            buf.setUint32(frame.frame_number);
+            buf.setUint32(frame.morph ? 1 : 0);
+            buf.setFloat(frame.position.x);
+            buf.setFloat(frame.position.y);
+
+            // First and second texture uv mapping coordinates as u, v, us, vs
+            const float uv[8] = {
+                frame.uv_mapping.a.x, frame.uv_mapping.a.y, frame.uv_mapping.c.x, frame.uv_mapping.c.y,
+                frame.uv_mapping2.a.x, frame.uv_mapping2.a.y, frame.uv_mapping2.c.x, frame.uv_mapping2.c.y
+            };
+
+            buf.writeArray(uv, 8);
+
+            // Drawing rect positions as x coordinates followed by y coordinates
+            const float xy[8] = {
+                frame.drawing_rect.a.x, frame.drawing_rect.b.x, frame.drawing_rect.c.x, frame.drawing_rect.d.x,
+                frame.drawing_rect.a.y, frame.drawing_rect.b.y, frame.drawing_rect.c.y, frame.drawing_rect.d.y
+            };
+
+            buf.writeArray(xy, 8);
+
+            buf.setUint32(frame.texture_index);
+            buf.setUint32(frame.anitype);
+            buf.setFloat(frame.anidelta);
+            buf.setFloat(frame.rz);
+
+            const float rgba[4] = {
+                static_cast<float>(frame.color.r), static_cast<float>(frame.color.g),
+                static_cast<float>(frame.color.b), static_cast<float>(frame.color.a)
+            };
+
+            buf.writeArray(rgba, 4);
+
+            // Blend types are stored 1-based
+            buf.setUint32(static_cast<uint32_t>(frame.src_blend_type) + 1);
+            buf.setUint32(static_cast<uint32_t>(frame.dest_blend_type) + 1);
+            buf.setUint32(frame.mtpreset);
+        }
+    }
+}
+
+size_t Str::serializedSize() const
+{
+    // Magic, version, fps, frame count, layer count and reserved bytes
+    size_t size = 4 + 4 * 4 + reserved.size();
+
+    for (const Layer& layer : layers)
+        size += 4 + layer.textures.size() * sizeof(Texture) + 4 + layer.frames.size() * frame_record_size;
+
+    return size;
+}
+
 } // namespace format
\ No newline at end of file
@@ -60,14 +60,31 @@ struct Str {
     };
 
     explicit Str() = default;
-    explicit Str(const Buffer& buf) { load(buf); }
+    explicit Str(const BufferView& buf) { load(buf); }
 
-    void load(const Buffer& buf);
-    void save(Buffer& buf) const { /* TODO */ }
+    /**
+     * Loads from memory buffer.
+     *
+     * @throws InvalidResource on failure.
+     */
+    void load(const BufferView& buf);
+
+    /**
+     * Saves to memory buffer, allocating it once. Loading keeps what's
+     * needed to save files back byte for byte, except colors, which are
+     * loaded as integers, and flags and blend types, which are normalized.
+     *
+     * @throws InvalidResource if version is unsupported.
+     */
+    void save(Buffer& buf) const;
+
+    /// Number of bytes written by save().
+    size_t serializedSize() const;
 
     uint32_t version;
     uint32_t fps;
     uint32_t frame_count;
+    std::array<uint8_t, 16> reserved{}; // unused, kept so saving is byte-exact
     std::vector<Layer> layers;
 };
 
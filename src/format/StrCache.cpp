@@ -0,0 +1,320 @@
+#include "StrCache.hpp"
+
+#include <string>
+#include <vector>
+#include "../util/InvalidResource.hpp"
+
+using namespace std;
+
+namespace format {
+
+static const char cache_magic[] = {'S', 'T', 'R', 'C'};
+static constexpr uint32_t cache_version = 1;
+
+/// Size of the header: magic, cache version, str version, fps, frame count, layer count and reserved bytes.
+static constexpr size_t header_size = sizeof(cache_magic) + 5 * 4 + 16;
+
+/// Size of the fields of a keyframe, summed over every field array.
+static constexpr size_t keyframe_size = 4 * 4 + sizeof(Color) + 2 * 4 + sizeof(Point2D)
+    + 2 * sizeof(StrCache::Uv) + sizeof(StrCache::Corners) + 3;
+
+static_assert(sizeof(StrCache::Uv) == 16 && sizeof(StrCache::Corners) == 32 && sizeof(Point2D) == 8,
+              "cache field sizes don't match the file");
+
+static size_t align4(size_t offset) { return (offset + 3) & ~size_t(3); }
+
+/// Size of the field arrays of count keyframes, padding included.
+static size_t keyframesSize(size_t count) { return align4(count * keyframe_size); }
+
+/// Spans count elements at field, moving field past them.
+template <typename T>
+static Span<const T> takeArray(const uint8_t*& field, size_t count)
+{
+    const Span<const T> span(reinterpret_cast<const T*>(field), count);
+    field += count * sizeof(T);
+    return span;
+}
+
+static void pad4(Buffer& buf, size_t base)
+{
+    static const uint8_t zeros[3] = {};
+    buf.write(zeros, align4(buf.tell() - base) - (buf.tell() - base));
+}
+
+void StrCache::save(const Str& str, Buffer& buf)
+{
+    const size_t base = buf.tell();
+
+    // Lay out layer data, then texture names, after the layer table
+    size_t size = header_size + str.layers.size() * sizeof(LayerRecord);
+    vector<LayerRecord> records(str.layers.size());
+
+    for (size_t i = 0; i < str.layers.size(); i++)
+    {
+        const Str::Layer& layer = str.layers[i];
+
+        records[i].texture_count = static_cast<uint32_t>(layer.textures.size());
+        records[i].textures_offset = static_cast<uint32_t>(size);
+        size += layer.textures.size() * 4;
+
+        records[i].keyframe_count = static_cast<uint32_t>(layer.frames.size());
+        records[i].keyframes_offset = static_cast<uint32_t>(size);
+        size += keyframesSize(layer.frames.size());
+    }
+
+    const size_t names_offset = size;
+
+    for (const Str::Layer& layer : str.layers)
+    {
+        for (const Str::Texture& texture : layer.textures)
+            size += strnlen(texture.filename.data(), texture.filename.size()) + 1;
+    }
+
+    if (size > 0xFFFFFFFF)
+        throw InvalidResource("str cache: str is too large");
+
+    buf.reserve(base + align4(size));
+
+    // Header
+    buf.write(cache_magic, sizeof(cache_magic));
+    buf.writeUint32(cache_version);
+    buf.writeUint32(str.version);
+    buf.writeUint32(str.fps);
+    buf.writeUint32(str.frame_count);
+    buf.writeUint32(static_cast<uint32_t>(str.layers.size()));
+    buf.write(str.reserved.data(), str.reserved.size());
+    buf.writeArray(records.data(), records.size());
+
+    size_t name_offset = names_offset;
+
+    for (const Str::Layer& layer : str.layers)
+    {
+        // Texture name offsets
+        for (const Str::Texture& texture : layer.textures)
+        {
+            buf.writeUint32(static_cast<uint32_t>(name_offset));
+            name_offset += strnlen(texture.filename.data(), texture.filename.size()) + 1;
+        }
+
+        // Keyframe fields, each in its own array
+        const vector<Str::Frame>& frames = layer.frames;
+
+        for (const Str::Frame& frame : frames) buf.writeUint32(frame.frame_number);
+        for (const Str::Frame& frame : frames) buf.writeUint32(frame.texture_index);
+        for (const Str::Frame& frame : frames) buf.writeUint32(frame.anitype);
+        for (const Str::Frame& frame : frames) buf.writeUint32(frame.mtpreset);
+        for (const Str::Frame& frame : frames) buf.writeArray(&frame.color, 1);
+        for (const Str::Frame& frame : frames) buf.writeFloat(frame.anidelta);
+        for (const Str::Frame& frame : frames) buf.writeFloat(frame.rz);
+        for (const Str::Frame& frame : frames) buf.writeArray(&frame.position, 1);
+
+        for (const Str::Frame& frame : frames)
+        {
+            const Uv uv = { frame.uv_mapping.a.x, frame.uv_mapping.a.y, frame.uv_mapping.c.x, frame.uv_mapping.c.y };
+            buf.writeArray(&uv, 1);
+        }
+
+        for (const Str::Frame& frame : frames)
+        {
+            const Uv uv = { frame.uv_mapping2.a.x, frame.uv_mapping2.a.y, frame.uv_mapping2.c.x, frame.uv_mapping2.c.y };
+            buf.writeArray(&uv, 1);
+        }
+
+        for (const Str::Frame& frame : frames)
+        {
+            const Rect<Point2D>& rect = frame.drawing_rect;
+            const Corners corners = {
+                { rect.a.x, rect.b.x, rect.c.x, rect.d.x },
+                { rect.a.y, rect.b.y, rect.c.y, rect.d.y }
+            };
+
+            buf.writeArray(&corners, 1);
+        }
+
+        for (const Str::Frame& frame : frames) buf.writeUint8(frame.morph ? 1 : 0);
+        for (const Str::Frame& frame : frames) buf.writeUint8(static_cast<uint8_t>(frame.src_blend_type));
+        for (const Str::Frame& frame : frames) buf.writeUint8(static_cast<uint8_t>(frame.dest_blend_type));
+
+        pad4(buf, base);
+    }
+
+    // Texture names
+    for (const Str::Layer& layer : str.layers)
+    {
+        for (const Str::Texture& texture : layer.textures)
+        {
+            buf.write(texture.filename.data(), strnlen(texture.filename.data(), texture.filename.size()));
+            buf.writeUint8(0);
+        }
+    }
+
+    pad4(buf, base);
+}
+
+void StrCache::open(const char* filename)
+{
+    MappedFile file(filename);
+    load(file);
+    file_ = move(file);
+}
+
+void StrCache::load(const BufferView& buf)
+try {
+    layer_count_ = 0;
+    data_ = BufferView(buf.data() + buf.tell(), buf.remaining());
+
+    if (reinterpret_cast<uintptr_t>(data_.data()) % 4 != 0)
+        throw InvalidResource("str cache: data is not aligned to 4 bytes");
+
+    char magic[sizeof(cache_magic)];
+    data_.read(magic, sizeof(magic));
+
+    // Check magic
+    if (memcmp(magic, cache_magic, sizeof(cache_magic)) != 0)
+        throw InvalidResource("str cache: invalid magic, expected 'STRC'");
+
+    const uint32_t file_version = data_.readUint32();
+
+    if (file_version != cache_version)
+        throw InvalidResource("str cache: unsupported version '" + to_string(file_version) + "'");
+
+    version = data_.readUint32();
+    fps = data_.readUint32();
+    frame_count = data_.readUint32();
+    const size_t layer_count = data_.readUint32();
+    data_.read(reserved.data(), reserved.size());
+
+    // Layer table, and the ranges it points to
+    layers_offset_ = data_.tell();
+    data_.require(layer_count * sizeof(LayerRecord));
+
+    for (size_t i = 0; i < layer_count; i++)
+    {
+        const LayerRecord record = layerRecord(i);
+
+        if (record.keyframes_offset % 4 != 0)
+            throw InvalidResource("str cache: misaligned keyframes of layer " + to_string(i));
+
+        data_.seek(record.textures_offset);
+        data_.require(static_cast<size_t>(record.texture_count) * 4);
+
+        for (size_t j = 0; j < record.texture_count; j++)
+        {
+            const size_t name_offset = data_.getUint32();
+
+            if (name_offset >= data_.size() || !memchr(data_.data() + name_offset, '\0', data_.size() - name_offset))
+                throw InvalidResource("str cache: invalid texture name in layer " + to_string(i));
+        }
+
+        data_.seek(record.keyframes_offset);
+        data_.require(keyframesSize(record.keyframe_count));
+    }
+
+    layer_count_ = layer_count;
+}
+catch (const out_of_range&) {
+    throw InvalidResource("str cache: missing data");
+}
+
+const char* StrCache::textureName(size_t layer_index, size_t texture_index) const noexcept
+{
+    uint32_t name_offset;
+    memcpy(&name_offset, data_.data() + layerRecord(layer_index).textures_offset + texture_index * 4, 4);
+
+    return reinterpret_cast<const char*>(data_.data() + name_offset);
+}
+
+StrCache::Keyframes StrCache::keyframes(size_t layer_index) const noexcept
+{
+    const LayerRecord record = layerRecord(layer_index);
+    const size_t count = record.keyframe_count;
+    const uint8_t* field = data_.data() + record.keyframes_offset;
+
+    Keyframes keyframes;
+    keyframes.frame_numbers = takeArray<uint32_t>(field, count);
+    keyframes.texture_indices = takeArray<uint32_t>(field, count);
+    keyframes.anitypes = takeArray<uint32_t>(field, count);
+    keyframes.mtpresets = takeArray<uint32_t>(field, count);
+    keyframes.colors = takeArray<Color>(field, count);
+    keyframes.anideltas = takeArray<float>(field, count);
+    keyframes.rotations = takeArray<float>(field, count);
+    keyframes.positions = takeArray<Point2D>(field, count);
+    keyframes.uv_mappings = takeArray<Uv>(field, count);
+    keyframes.uv_mappings2 = takeArray<Uv>(field, count);
+    keyframes.drawing_rects = takeArray<Corners>(field, count);
+    keyframes.morphs = takeArray<uint8_t>(field, count);
+    keyframes.src_blend_types = takeArray<uint8_t>(field, count);
+    keyframes.dest_blend_types = takeArray<uint8_t>(field, count);
+    return keyframes;
+}
+
+static Str::Frame::BlendType blendType(uint8_t value)
+{
+    return (value <= Str::Frame::BothInvSrcAlpha ? static_cast<Str::Frame::BlendType>(value) : Str::Frame::Zero);
+}
+
+static Rect<Point2D> uvRect(const StrCache::Uv& uv)
+{
+    return Rect<Point2D>(Point2D(uv.u, uv.v), Point2D(uv.us, uv.v), Point2D(uv.us, uv.vs), Point2D(uv.u, uv.vs));
+}
+
+Str StrCache::toStr() const
+{
+    Str str;
+    str.version = version;
+    str.fps = fps;
+    str.frame_count = frame_count;
+    str.reserved = reserved;
+    str.layers.resize(layer_count_);
+
+    for (size_t i = 0; i < layer_count_; i++)
+    {
+        Str::Layer& layer = str.layers[i];
+
+        // Textures
+        layer.textures.resize(textureCount(i));
+
+        for (size_t j = 0; j < layer.textures.size(); j++)
+        {
+            const char* name = textureName(i, j);
+            Str::Texture& texture = layer.textures[j];
+
+            texture.filename.fill('\0');
+            memcpy(texture.filename.data(), name, strnlen(name, texture.filename.size() - 1));
+        }
+
+        // Keyframes
+        const Keyframes keys = keyframes(i);
+        layer.frames.resize(keys.size());
+
+        for (size_t j = 0; j < keys.size(); j++)
+        {
+            Str::Frame& frame = layer.frames[j];
+            const Corners& corners = keys.drawing_rects[j];
+
+            frame.frame_number = keys.frame_numbers[j];
+            frame.morph = (keys.morphs[j] != 0);
+            frame.position = keys.positions[j];
+            frame.uv_mapping = uvRect(keys.uv_mappings[j]);
+            frame.uv_mapping2 = uvRect(keys.uv_mappings2[j]);
+            frame.drawing_rect = Rect<Point2D>(
+                Point2D(corners.x[0], corners.y[0]),
+                Point2D(corners.x[1], corners.y[1]),
+                Point2D(corners.x[2], corners.y[2]),
+                Point2D(corners.x[3], corners.y[3])
+            );
+            frame.texture_index = keys.texture_indices[j];
+            frame.anitype = keys.anitypes[j];
+            frame.anidelta = keys.anideltas[j];
+            frame.rz = keys.rotations[j];
+            frame.color = keys.colors[j];
+            frame.src_blend_type = blendType(keys.src_blend_types[j]);
+            frame.dest_blend_type = blendType(keys.dest_blend_types[j]);
+            frame.mtpreset = keys.mtpresets[j];
+        }
+    }
+
+    return str;
+}
+
+} // namespace format
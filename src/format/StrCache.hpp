@@ -0,0 +1,130 @@
+#ifndef ROTOOLS_FORMAT_STRCACHE_HPP
+#define ROTOOLS_FORMAT_STRCACHE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "Str.hpp"
+#include "../util/Buffer.hpp"
+#include "../util/MappedFile.hpp"
+#include "../util/Point2D.hpp"
+#include "../util/Span.hpp"
+
+namespace format {
+
+/**
+ * Read-only Str in a compact cache file, read in place.
+ *
+ * Each layer's keyframes are stored field by field, as arrays aligned to 4
+ * bytes, so opening a cache only checks its layer table and every field is
+ * a span into the file. Keyframes take 103 bytes instead of 124 in a str
+ * file and about 150 in a loaded Str, since uv mappings are stored as
+ * u, v, us, vs rather than four corners and colors as bytes. Texture names
+ * are stored once, without padding.
+ */
+class StrCache final {
+public:
+    /// Uv mapping as stored in str files, spanning (u, v) to (us, vs).
+    struct Uv {
+        float u, v, us, vs;
+    };
+
+    /// Drawing rect corners a, b, c and d.
+    struct Corners {
+        float x[4];
+        float y[4];
+    };
+
+    /// Keyframes of a layer, one element per keyframe in each span.
+    struct Keyframes {
+        Span<const uint32_t> frame_numbers;
+        Span<const uint32_t> texture_indices;
+        Span<const uint32_t> anitypes;
+        Span<const uint32_t> mtpresets;
+        Span<const Color> colors;
+        Span<const float> anideltas;
+        Span<const float> rotations;
+        Span<const Point2D> positions;
+        Span<const Uv> uv_mappings;
+        Span<const Uv> uv_mappings2;
+        Span<const Corners> drawing_rects;
+        Span<const uint8_t> morphs;
+        Span<const uint8_t> src_blend_types;  // Str::Frame::BlendType
+        Span<const uint8_t> dest_blend_types; // Str::Frame::BlendType
+
+        size_t size() const noexcept { return frame_numbers.size(); }
+    };
+
+    /**
+     * Saves str in the cache format to memory buffer.
+     *
+     * @throws InvalidResource if str is too large for the format.
+     */
+    static void save(const Str& str, Buffer& buf);
+
+    /// Constructs an empty StrCache.
+    explicit StrCache() = default;
+
+    /// Constructs and opens a cache file.
+    explicit StrCache(const char* filename) { open(filename); }
+
+    /**
+     * Maps a cache file and checks it.
+     *
+     * @throws FileNotOpen if the file cannot be mapped.
+     * @throws InvalidResource if the file is invalid.
+     */
+    void open(const char* filename);
+
+    /**
+     * Checks a cache in memory, which must outlive this object and be
+     * aligned to 4 bytes, as are mapped files and buffers.
+     *
+     * @throws InvalidResource on failure.
+     */
+    void load(const BufferView& buf);
+
+    size_t layerCount() const noexcept { return layer_count_; }
+
+    /// Number of textures of a layer, which must be less than layerCount().
+    size_t textureCount(size_t layer_index) const noexcept { return layerRecord(layer_index).texture_count; }
+
+    /// Texture filename of a layer, null-terminated.
+    const char* textureName(size_t layer_index, size_t texture_index) const noexcept;
+
+    /// Keyframes of a layer, which must be less than layerCount().
+    Keyframes keyframes(size_t layer_index) const noexcept;
+
+    /// Expands into a Str.
+    Str toStr() const;
+
+    uint32_t version = 0; // of the str
+    uint32_t fps = 0;
+    uint32_t frame_count = 0;
+    std::array<uint8_t, 16> reserved{};
+
+private:
+    struct LayerRecord {
+        uint32_t texture_count;
+        uint32_t textures_offset;  // of the offsets of each texture name
+        uint32_t keyframe_count;
+        uint32_t keyframes_offset; // of the first field array
+    };
+
+    LayerRecord layerRecord(size_t layer_index) const noexcept
+    {
+        LayerRecord record;
+        std::memcpy(&record, data_.data() + layers_offset_ + layer_index * sizeof(LayerRecord), sizeof(record));
+        return record;
+    }
+
+    MappedFile file_;
+    BufferView data_;
+    size_t layer_count_ = 0;
+    size_t layers_offset_ = 0;
+};
+
+} // namespace format
+
+#endif // ROTOOLS_FORMAT_STRCACHE_HPP
@@ -0,0 +1,84 @@
+#include "StrCursor.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace format {
+
+StrCursor::StrCursor(const Str::Layer& layer)
+    : frames_{ layer.frames.data() }
+{
+    entries_.resize(layer.frames.size());
+
+    uint32_t max_frame_number = 0;
+    int32_t last_base = -1;
+
+    for (size_t i = 0; i < entries_.size(); i++)
+    {
+        const Str::Frame& frame = layer.frames[i];
+
+        max_frame_number = max(max_frame_number, frame.frame_number);
+
+        if (!frame.morph)
+            last_base = static_cast<int32_t>(i);
+
+        entries_[i] = { max_frame_number, last_base };
+    }
+}
+
+void StrCursor::seek(uint32_t frame_number)
+{
+    const bool adjacent = positioned_
+        && (frame_number == frame_number_ + 1 || frame_number + 1 == frame_number_ || frame_number == frame_number_);
+
+    if (adjacent)
+    {
+        // Walk keyframes from the current position
+        while (shown_count_ < entries_.size() && entries_[shown_count_].max_frame_number <= frame_number)
+            shown_count_++;
+
+        while (shown_count_ > 0 && entries_[shown_count_ - 1].max_frame_number > frame_number)
+            shown_count_--;
+    }
+    else
+    {
+        const auto past = upper_bound(entries_.begin(), entries_.end(), frame_number, [](uint32_t number, const Entry& entry) {
+            return number < entry.max_frame_number;
+        });
+
+        shown_count_ = static_cast<size_t>(past - entries_.begin());
+    }
+
+    frame_number_ = frame_number;
+    positioned_ = true;
+    select(frame_number);
+}
+
+void StrCursor::select(uint32_t frame_number)
+{
+    if (shown_count_ > 0)
+    {
+        const size_t last = shown_count_ - 1;
+        const int32_t last_base = entries_[last].last_base;
+
+        if (!frames_[last].morph) {
+            base_ = &frames_[last];
+            morph_ = nullptr;
+        }
+        else {
+            morph_ = &frames_[last];
+
+            // Without a base keyframe in the prefix, the previous base stays
+            if (last_base >= 0)
+                base_ = &frames_[last_base];
+        }
+    }
+
+    const bool found = (shown_count_ > 0 && frames_[shown_count_ - 1].frame_number == frame_number);
+
+    if (!found && !morph_)
+        base_ = nullptr;
+}
+
+} // namespace format
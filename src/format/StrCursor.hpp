@@ -0,0 +1,64 @@
+#ifndef ROTOOLS_FORMAT_STRCURSOR_HPP
+#define ROTOOLS_FORMAT_STRCURSOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Str.hpp"
+
+namespace format {
+
+/**
+ * Finds the keyframes of a Str layer shown at a frame number.
+ *
+ * Keyframes shown at a frame are those before the first keyframe past it,
+ * so the cursor keeps the running maximum of frame numbers, which makes
+ * that prefix searchable even if keyframes are out of order. Moving to the
+ * next or previous frame walks from the current position, in constant time
+ * amortized over an effect's playback, and any other frame is binary
+ * searched.
+ *
+ * A frame shows the last base keyframe of the prefix, along with the morph
+ * keyframe following it, if any. As in the original playback, a prefix of
+ * only morph keyframes keeps the base shown before the move, and nothing is
+ * shown if no keyframe matches the frame and there's no morph keyframe.
+ */
+class StrCursor final {
+public:
+    /// Constructs a cursor over no keyframes.
+    explicit StrCursor() = default;
+
+    /// Constructs a cursor over the keyframes of layer, which must outlive it, at no frame.
+    explicit StrCursor(const Str::Layer& layer);
+
+    /// Moves to frame_number.
+    void seek(uint32_t frame_number);
+
+    /// Base keyframe shown, or null if none.
+    const Str::Frame* base() const noexcept { return base_; }
+
+    /// Morph keyframe applied to base, or null if none.
+    const Str::Frame* morph() const noexcept { return morph_; }
+
+private:
+    struct Entry {
+        uint32_t max_frame_number; // maximum frame number up to this keyframe
+        int32_t last_base;         // index of the last base keyframe up to this one, or -1
+    };
+
+    /// Selects the keyframes shown once the prefix shown is found.
+    void select(uint32_t frame_number);
+
+    const Str::Frame* frames_ = nullptr;
+    std::vector<Entry> entries_;
+    size_t shown_count_ = 0; // keyframes before the first one past the current frame
+    uint32_t frame_number_ = 0;
+    bool positioned_ = false;
+
+    const Str::Frame* base_ = nullptr;
+    const Str::Frame* morph_ = nullptr;
+};
+
+} // namespace format
+
+#endif // ROTOOLS_FORMAT_STRCURSOR_HPP
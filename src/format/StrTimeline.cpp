@@ -0,0 +1,113 @@
+#include "StrTimeline.hpp"
+
+#include <cmath>
+#include "StrCursor.hpp"
+
+using namespace std;
+
+namespace format {
+
+/// Str rotations span [0, 1024[ for a full turn, about 2.8444 per degree.
+constexpr float str_angle_to_degrees = 2.8444f;
+
+static void morphPoint(Point2D& point, const Point2D& delta, int factor)
+{
+    point.x += delta.x * factor;
+    point.y += delta.y * factor;
+}
+
+static void morphRect(Rect<Point2D>& rect, const Rect<Point2D>& delta, int factor)
+{
+    morphPoint(rect.a, delta.a, factor);
+    morphPoint(rect.b, delta.b, factor);
+    morphPoint(rect.c, delta.c, factor);
+    morphPoint(rect.d, delta.d, factor);
+}
+
+void StrTimeline::bake(const Str& str)
+{
+    quads.clear();
+    frame_offsets.clear();
+    frame_offsets.reserve(str.frame_count + 1);
+
+    vector<StrCursor> cursors;
+    cursors.reserve(str.layers.size());
+
+    for (const Str::Layer& layer : str.layers)
+        cursors.emplace_back(layer);
+
+    for (uint32_t frame_number = 0; frame_number < str.frame_count; frame_number++)
+    {
+        frame_offsets.push_back(static_cast<uint32_t>(quads.size()));
+
+        for (uint32_t layer_index = 0; layer_index < cursors.size(); layer_index++)
+        {
+            StrCursor& cursor = cursors[layer_index];
+            cursor.seek(frame_number);
+
+            if (!cursor.base())
+                continue;
+
+            Quad quad;
+
+            if (evaluate(str, layer_index, *cursor.base(), cursor.morph(), frame_number, quad))
+                quads.push_back(quad);
+        }
+    }
+
+    frame_offsets.push_back(static_cast<uint32_t>(quads.size()));
+    quads.shrink_to_fit();
+}
+
+bool StrTimeline::evaluate(const Str& str, uint32_t layer_index, const Str::Frame& base,
+                           const Str::Frame* morph, uint32_t frame_number, Quad& quad)
+{
+    // Draw frame only if alpha is more than zero and its texture exists
+    if (base.color.a == 0 || base.texture_index >= str.layers[layer_index].textures.size())
+        return false;
+
+    Color color = base.color;
+    Point2D position = base.position;
+    Rect<Point2D> drawing_rect = base.drawing_rect;
+    Rect<Point2D> uv_mapping = base.uv_mapping;
+    float rotation = base.rz / str_angle_to_degrees;
+
+    // Apply a few modifications if there's a morph frame along with base frame
+    if (morph)
+    {
+        const int factor = static_cast<int>(frame_number - morph->frame_number);
+
+        color.r += morph->color.r * factor;
+        color.g += morph->color.g * factor;
+        color.b += morph->color.b * factor;
+        color.a += morph->color.a * factor;
+
+        morphPoint(position, morph->position, factor);
+        morphRect(drawing_rect, morph->drawing_rect, factor);
+        morphRect(uv_mapping, morph->uv_mapping, factor);
+
+        rotation += (morph->rz / str_angle_to_degrees) * factor;
+    }
+
+    // Rotate about the origin, then translate to position
+    const float radians = rotation * 3.14159265f / 180.f;
+    const float cos_r = cos(radians);
+    const float sin_r = sin(radians);
+
+    const auto place = [&](const Point2D& point) {
+        return Point2D(position.x + point.x * cos_r - point.y * sin_r,
+                       position.y + point.x * sin_r + point.y * cos_r);
+    };
+
+    quad.layer_index = layer_index;
+    quad.texture_index = base.texture_index;
+    quad.vertices = Rect<Point2D>(place(drawing_rect.a), place(drawing_rect.b), place(drawing_rect.c), place(drawing_rect.d));
+    quad.uv_mapping = uv_mapping;
+    quad.color = color;
+    quad.src_blend_type = base.src_blend_type;
+    quad.dest_blend_type = base.dest_blend_type;
+
+    return true;
+}
+
+} // namespace format
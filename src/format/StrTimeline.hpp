@@ -0,0 +1,68 @@
+#ifndef ROTOOLS_FORMAT_STRTIMELINE_HPP
+#define ROTOOLS_FORMAT_STRTIMELINE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Str.hpp"
+#include "../util/Color.hpp"
+#include "../util/Point2D.hpp"
+#include "../util/Rect.hpp"
+#include "../util/Span.hpp"
+
+namespace format {
+
+/**
+ * Str evaluated into the quads drawn at each of its frames.
+ *
+ * Baking plays the str once from its first frame, applying morph keyframes
+ * and placing each layer's drawing rect with its rotation and position, so
+ * playing it back is a lookup. Quads of every frame are stored in one
+ * array, in layer order.
+ */
+struct StrTimeline {
+    /// Layer's quad at a frame, ready to draw.
+    struct Quad {
+        uint32_t layer_index;
+        uint32_t texture_index;       // of the layer's textures
+        Rect<Point2D> vertices;       // drawing rect rotated and translated into place
+        Rect<Point2D> uv_mapping;
+        Color color;
+        Str::Frame::BlendType src_blend_type;
+        Str::Frame::BlendType dest_blend_type;
+    };
+
+    /// Constructs an empty timeline.
+    explicit StrTimeline() = default;
+
+    /// Constructs and bakes str.
+    explicit StrTimeline(const Str& str) { bake(str); }
+
+    /// Evaluates every frame of str.
+    void bake(const Str& str);
+
+    /**
+     * Evaluates the quad of a layer showing base, morphed by morph if not
+     * null, at frame_number.
+     *
+     * @return Whether there's anything to draw, which requires a visible
+     *         base and a texture index within the layer's textures.
+     */
+    static bool evaluate(const Str& str, uint32_t layer_index, const Str::Frame& base,
+                         const Str::Frame* morph, uint32_t frame_number, Quad& quad);
+
+    size_t frameCount() const noexcept { return frame_offsets.empty() ? 0 : frame_offsets.size() - 1; }
+
+    /// Quads drawn at frame, which must be less than frameCount().
+    Span<const Quad> quadsAt(size_t frame) const noexcept
+    {
+        return { quads.data() + frame_offsets[frame], frame_offsets[frame + 1] - frame_offsets[frame] };
+    }
+
+    std::vector<Quad> quads;
+    std::vector<uint32_t> frame_offsets; // where each frame's quads start, followed by their end
+};
+
+} // namespace format
+
+#endif // ROTOOLS_FORMAT_STRTIMELINE_HPP
@@ -0,0 +1,283 @@
+#include "ZeroRle.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include "../util/InvalidResource.hpp"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ROTOOLS_ZERORLE_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace format {
+
+namespace {
+
+/// Position in the source and destination buffers.
+struct Cursor {
+    const uint8_t* src;
+    const uint8_t* src_end;
+    uint8_t* dest;
+    uint8_t* dest_end;
+    uint8_t* dirty_end; // end of the bytes past dest written ahead by vector stores
+};
+
+/// Copies bytes up to the next zero byte or the end of either buffer.
+void copyLiteralsScalar(Cursor& c)
+{
+    while (c.src < c.src_end && c.dest < c.dest_end && *c.src != 0)
+        *c.dest++ = *c.src++;
+}
+
+/// Finds the first non-zero byte in [begin, end), or end if there's none.
+const uint8_t* skipZerosScalar(const uint8_t* begin, const uint8_t* end)
+{
+    while (begin < end && *begin == 0)
+        begin++;
+
+    return begin;
+}
+
+#ifdef ROTOOLS_ZERORLE_X86
+
+/*
+ * Vector versions store whole blocks to dest before knowing where the next
+ * zero byte is, then advance only up to it. Bytes stored past it are either
+ * overwritten by what follows, cleared once decoding ends or left past the
+ * encoded size.
+ */
+
+__attribute__((target("sse2")))
+void copyLiteralsSse2(Cursor& c)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    while (c.src_end - c.src >= 16 && c.dest_end - c.dest >= 16)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.src));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(c.dest), block);
+
+        const unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, zero));
+
+        if (mask) {
+            const unsigned int n = __builtin_ctz(mask);
+            c.dirty_end = max(c.dirty_end, c.dest + 16);
+            c.src += n;
+            c.dest += n;
+            return;
+        }
+
+        c.src += 16;
+        c.dest += 16;
+    }
+
+    copyLiteralsScalar(c);
+}
+
+__attribute__((target("sse2")))
+const uint8_t* skipZerosSse2(const uint8_t* begin, const uint8_t* end)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; end - begin >= 16; begin += 16)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        const unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, zero));
+
+        if (mask != 0xFFFF)
+            return begin + __builtin_ctz(~mask);
+    }
+
+    return skipZerosScalar(begin, end);
+}
+
+__attribute__((target("avx2")))
+void copyLiteralsAvx2(Cursor& c)
+{
+    const __m256i zero = _mm256_setzero_si256();
+
+    while (c.src_end - c.src >= 32 && c.dest_end - c.dest >= 32)
+    {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.src));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(c.dest), block);
+
+        const unsigned int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, zero));
+
+        if (mask) {
+            const unsigned int n = __builtin_ctz(mask);
+            c.dirty_end = max(c.dirty_end, c.dest + 32);
+            c.src += n;
+            c.dest += n;
+            return;
+        }
+
+        c.src += 32;
+        c.dest += 32;
+    }
+
+    copyLiteralsSse2(c);
+}
+
+__attribute__((target("avx2")))
+const uint8_t* skipZerosAvx2(const uint8_t* begin, const uint8_t* end)
+{
+    const __m256i zero = _mm256_setzero_si256();
+
+    for (; end - begin >= 32; begin += 32)
+    {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        const unsigned int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, zero));
+
+        if (mask != 0xFFFFFFFF)
+            return begin + __builtin_ctz(~mask);
+    }
+
+    return skipZerosSse2(begin, end);
+}
+
+#endif // ROTOOLS_ZERORLE_X86
+
+template <void (*CopyLiterals)(Cursor&)>
+void decode(const uint8_t* src, size_t src_size, uint8_t* dest, size_t dest_size)
+{
+    Cursor c{ src, src + src_size, dest, dest + dest_size, dest };
+
+    for (;;)
+    {
+        CopyLiterals(c);
+
+        if (c.src == c.src_end || c.dest == c.dest_end)
+            break;
+
+        // Run of index 0
+        if (c.src_end - c.src < 2)
+            throw InvalidResource("spr: missing zero run length in pal image");
+
+        const size_t len = c.src[1] ? c.src[1] : 1;
+        c.src += 2;
+
+        if (len > static_cast<size_t>(c.dest_end - c.dest))
+            throw InvalidResource("spr: too much encoded data for pal image");
+
+        memset(c.dest, 0, len);
+        c.dest += len;
+    }
+
+    if (c.dirty_end > c.dest)
+        memset(c.dest, 0, c.dirty_end - c.dest);
+}
+
+template <void (*CopyLiterals)(Cursor&), const uint8_t* (*SkipZeros)(const uint8_t*, const uint8_t*)>
+size_t encode(const uint8_t* src, size_t src_size, uint8_t* dest) noexcept
+{
+    // Literals take as many bytes as they had and zero runs at most twice as many, so dest never fills up early
+    Cursor c{ src, src + src_size, dest, dest + zeroRleBound(src_size), dest };
+
+    for (;;)
+    {
+        CopyLiterals(c);
+
+        if (c.src == c.src_end)
+            break;
+
+        // Run of index 0
+        const uint8_t* run_end = SkipZeros(c.src, c.src_end);
+        size_t run = run_end - c.src;
+        c.src = run_end;
+
+        for (; run > 255; run -= 255) {
+            *c.dest++ = 0;
+            *c.dest++ = 255;
+        }
+
+        *c.dest++ = 0;
+        *c.dest++ = static_cast<uint8_t>(run);
+    }
+
+    return c.dest - dest;
+}
+
+using DecodeFunction = void (*)(const uint8_t*, size_t, uint8_t*, size_t);
+using EncodeFunction = size_t (*)(const uint8_t*, size_t, uint8_t*) noexcept;
+
+struct Functions {
+    DecodeFunction decode;
+    EncodeFunction encode;
+};
+
+bool supported(ZeroRleIsa isa) noexcept
+{
+    switch (isa)
+    {
+#ifdef ROTOOLS_ZERORLE_X86
+        case ZeroRleIsa::Avx2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+        case ZeroRleIsa::Sse2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+#endif
+        case ZeroRleIsa::Scalar:
+            return true;
+        default:
+            return false;
+    }
+}
+
+Functions functionsFor(ZeroRleIsa isa) noexcept
+{
+    switch (isa)
+    {
+#ifdef ROTOOLS_ZERORLE_X86
+        case ZeroRleIsa::Avx2:
+            return { decode<copyLiteralsAvx2>, encode<copyLiteralsAvx2, skipZerosAvx2> };
+        case ZeroRleIsa::Sse2:
+            return { decode<copyLiteralsSse2>, encode<copyLiteralsSse2, skipZerosSse2> };
+#endif
+        default:
+            return { decode<copyLiteralsScalar>, encode<copyLiteralsScalar, skipZerosScalar> };
+    }
+}
+
+Functions selectFunctions()
+{
+    for (ZeroRleIsa isa : { ZeroRleIsa::Avx2, ZeroRleIsa::Sse2 })
+    {
+        if (supported(isa))
+            return functionsFor(isa);
+    }
+
+    return functionsFor(ZeroRleIsa::Scalar);
+}
+
+const Functions& functions()
+{
+    static const Functions selected = selectFunctions();
+    return selected;
+}
+
+} // namespace
+
+void decodeZeroRle(const uint8_t* src, size_t src_size, uint8_t* dest, size_t dest_size)
+{
+    functions().decode(src, src_size, dest, dest_size);
+}
+
+size_t encodeZeroRle(const uint8_t* src, size_t src_size, uint8_t* dest) noexcept
+{
+    return functions().encode(src, src_size, dest);
+}
+
+bool zeroRleSupported(ZeroRleIsa isa) noexcept
+{
+    return supported(isa);
+}
+
+size_t encodeZeroRle(ZeroRleIsa isa, const uint8_t* src, size_t src_size, uint8_t* dest) noexcept
+{
+    return functionsFor(isa).encode(src, src_size, dest);
+}
+
+} // namespace format
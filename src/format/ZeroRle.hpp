@@ -0,0 +1,51 @@
+#ifndef ROTOOLS_FORMAT_ZERORLE_HPP
+#define ROTOOLS_FORMAT_ZERORLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace format {
+
+/**
+ * Decodes palette indices encoded as in Spr 2.1, where each run of index 0
+ * is stored as a 0 byte followed by the run length (0 meaning 1) and any
+ * other index is stored as is.
+ *
+ * Decoding stops when either buffer is exhausted, so pixels left over stay
+ * 0. Scanning for zero bytes is vectorized with AVX2 or SSE2 if the CPU
+ * supports it.
+ *
+ * @throws InvalidResource if a run exceeds dest or its length is missing.
+ */
+void decodeZeroRle(const uint8_t* src, size_t src_size, uint8_t* dest, size_t dest_size);
+
+/// Maximum encoded size of src_size palette indices.
+constexpr size_t zeroRleBound(size_t src_size) noexcept { return src_size * 2; }
+
+/**
+ * Encodes palette indices as in Spr 2.1, splitting runs of index 0 longer
+ * than 255. dest must hold zeroRleBound(src_size) bytes.
+ *
+ * @return Encoded size.
+ */
+size_t encodeZeroRle(const uint8_t* src, size_t src_size, uint8_t* dest) noexcept;
+
+/// Instruction sets the zero-run codec can use.
+enum class ZeroRleIsa {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+/// Whether this CPU and build can run the codec with isa.
+bool zeroRleSupported(ZeroRleIsa isa) noexcept;
+
+/**
+ * Same as encodeZeroRle(), but forcing an instruction set, which must be
+ * supported. Meant for tests and benchmarks.
+ */
+size_t encodeZeroRle(ZeroRleIsa isa, const uint8_t* src, size_t src_size, uint8_t* dest) noexcept;
+
+} // namespace format
+
+#endif // ROTOOLS_FORMAT_ZERORLE_HPP
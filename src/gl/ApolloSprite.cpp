@@ -2,6 +2,7 @@
 
 #include <cmath>
 #include <glad/glad.h>
+#include "../format/PalLut.hpp"
 
 using namespace std;
 
@@ -21,105 +22,164 @@ void ApolloSprite::update(double dt)
 void ApolloSprite::draw(const Sprite& anchor_sprite) const
 {
     if (const ApolloSprite* other = dynamic_cast<const ApolloSprite*>(&anchor_sprite))
-    {
-        int this_anchor_x = currentFrame().anchor_x;
-        int this_anchor_y = currentFrame().anchor_y;
-        int other_anchor_x = other->currentFrame().anchor_x;
-        int other_anchor_y = other->currentFrame().anchor_y;
-
-        draw(other_anchor_x - this_anchor_x, other_anchor_y - this_anchor_y);
-    }
+        draw(other->anchorX() - anchorX(), other->anchorY() - anchorY());
 }
 
 void ApolloSprite::draw(int offset_x, int offset_y) const
 {
-    for (const format::Sprite::Layer& layer : currentFrame().layers)
+    beginDraw();
+
+    if (view_)
     {
-        auto image_index = layer.image_index;
+        for (const format::SpriteView::Layer& layer : view_frame_.layers)
+            drawLayer(layer.imageIndex(), layer.x() + offset_x, layer.y() + offset_y, layer.color(), layer.mirror());
+    }
+    else
+    {
+        for (const format::Sprite::Layer& layer : currentSpriteFrame().layers)
+            drawLayer(layer.image_index, layer.x + offset_x, layer.y + offset_y, layer.color, layer.mirror);
+    }
 
-        if (image_index >= sprite_.images.size())
-            continue;
+    endDraw();
+}
+
+void ApolloSprite::drawLayer(unsigned int image_index, int x, int y, const Color& c, bool mirror) const
+{
+    if (image_index >= textures_.size())
+        return;
 
-        const Color& c = layer.color;
-        const int w = sprite_.images[image_index].width;
-        const int h = sprite_.images[image_index].height;
-        const int x = layer.x - static_cast<int>(round(w / 2.0)) + offset_x;
-        const int y = layer.y - static_cast<int>(round(h / 2.0)) + offset_y;
+    const Texture& texture = *textures_[image_index];
+    const int w = texture.width();
+    const int h = texture.height();
+    x -= static_cast<int>(round(w / 2.0));
+    y -= static_cast<int>(round(h / 2.0));
 
-        textures_[image_index].bind();
+    texture.bind();
 
-        glBegin(GL_QUADS);
-        glColor4f(c.r / 255, c.g / 255, c.b / 255, c.a / 255);
+    glBegin(GL_QUADS);
+    glColor4f(c.r / 255, c.g / 255, c.b / 255, c.a / 255);
 
-        // Flip texture vertically and maybe horizontally
-        glTexCoord2d(layer.mirror ? 1 : 0, 0); glVertex3d(x,   y,   0); // top left
-        glTexCoord2d(layer.mirror ? 1 : 0, 1); glVertex3d(x,   y+h, 0); // bottom left
-        glTexCoord2d(layer.mirror ? 0 : 1, 1); glVertex3d(x+w, y+h, 0); // bottom right
-        glTexCoord2d(layer.mirror ? 0 : 1, 0); glVertex3d(x+w, y,   0); // top right
-        
-        glEnd();
-    }
+    // Flip texture vertically and maybe horizontally
+    glTexCoord2d(mirror ? 1 : 0, 0); glVertex3d(x,   y,   0); // top left
+    glTexCoord2d(mirror ? 1 : 0, 1); glVertex3d(x,   y+h, 0); // bottom left
+    glTexCoord2d(mirror ? 0 : 1, 1); glVertex3d(x+w, y+h, 0); // bottom right
+    glTexCoord2d(mirror ? 0 : 1, 0); glVertex3d(x+w, y,   0); // top right
 
-    Texture::unbind();
+    glEnd();
 }
 
 void ApolloSprite::advanceAnimation()
 {
-    if (++anim_idx_ >= sprite_.animations.size())
+    if (++anim_idx_ >= static_cast<int>(animationCount()))
         anim_idx_ = 0;
 
     frame_idx_ = 0;
+    updateViewFrame();
 }
 
 void ApolloSprite::recedeAnimation()
 {
     if (--anim_idx_ < 0)
-        anim_idx_ = sprite_.animations.size() - 1;
+        anim_idx_ = animationCount() - 1;
 
     frame_idx_ = 0;
+    updateViewFrame();
 }
 
 void ApolloSprite::advanceFrame()
 {
-    if (++frame_idx_ >= currentAnimation().frames.size())
+    if (++frame_idx_ >= static_cast<int>(frameCount()))
         frame_idx_ = 0;
+
+    updateViewFrame();
 }
 
 void ApolloSprite::recedeFrame()
 {
     if (--frame_idx_ < 0)
-        frame_idx_ = currentAnimation().frames.size() - 1;
+        frame_idx_ = frameCount() - 1;
+
+    updateViewFrame();
+}
+
+size_t ApolloSprite::animationCount() const
+{
+    return (view_ ? view_->animationCount() : sprite_->animations.size());
+}
+
+size_t ApolloSprite::frameCount() const
+{
+    return (view_ ? view_anim_.frame_count : sprite_->animations[anim_idx_].frames.size());
+}
+
+int ApolloSprite::anchorX() const
+{
+    return (view_ ? view_frame_.anchor_x : currentSpriteFrame().anchor_x);
+}
+
+int ApolloSprite::anchorY() const
+{
+    return (view_ ? view_frame_.anchor_y : currentSpriteFrame().anchor_y);
+}
+
+void ApolloSprite::updateViewFrame()
+{
+    if (!view_)
+        return;
+
+    view_anim_ = {};
+    view_frame_ = {};
+
+    if (anim_idx_ < 0 || static_cast<size_t>(anim_idx_) >= view_->animationCount())
+        return;
+
+    view_anim_ = view_->animation(anim_idx_);
+
+    if (frame_idx_ >= 0 && frame_idx_ < view_anim_.frame_count)
+        view_frame_ = view_->frame(view_anim_, frame_idx_);
 }
 
 void ApolloSprite::load()
 {
-    // Create textures for each palette image
-    for (const format::Sprite::Image& img : sprite_.images)
-    {
-        // First palette color is the transparency color.
-        const Color& transp_color = pal_.colors[0];
-        vector<uint8_t> pixels(img.indices.size() * 4);
+    // First palette color is the transparency color.
+    const format::PalLut lut(*pal_, format::PalLut::KeyedFirstColor);
+    vector<uint8_t> pixels;
+
+    loadPalette(lut);
 
-        for (int i = 0; i < img.indices.size(); i++)
+    if (!view_)
+    {
+        // Create textures for each palette image
+        for (const format::Sprite::Image& img : sprite_->images)
         {
-            uint8_t index = img.indices[i];
-            const Color& color = pal_.colors[index];
-
-            pixels[i*4 + 0] = color.r;
-            pixels[i*4 + 1] = color.g;
-            pixels[i*4 + 2] = color.b;
-            pixels[i*4 + 3] =
-                color.r == transp_color.r &&
-                color.g == transp_color.g &&
-                color.b == transp_color.b ?
-                0 : 255;
+            if (!addSharedTexture())
+                addTexture(img.width, img.height, img.indices.data(), lut, pixels);
         }
 
-        Texture texture(img.width, img.height, Texture::Rgba, pixels.data());
-        texture.setMagFilter(mag_filter_);
+        return;
+    }
+
+    // Uncompressed images are uploaded straight from the view
+    vector<uint8_t> indices;
+
+    for (size_t i = 0; i < view_->imageCount(); i++)
+    {
+        const format::SpriteView::Image img = view_->image(i);
+
+        if (addSharedTexture())
+            continue;
+
+        if (!img.compressed) {
+            addTexture(img.width, img.height, img.data.data(), lut, pixels);
+            continue;
+        }
 
-        textures_.emplace_back(std::move(texture));
+        indices.resize(static_cast<size_t>(img.width) * img.height);
+        img.decode(indices.data());
+        addTexture(img.width, img.height, indices.data(), lut, pixels);
     }
+
+    updateViewFrame();
 }
 
 } // namespace gl
\ No newline at end of file
@@ -4,14 +4,23 @@
 #include "Sprite.hpp"
 #include "../format/Pal.hpp"
 #include "../format/Sprite.hpp"
+#include "../format/SpriteView.hpp"
 
 namespace gl {
 
+/**
+ * Renders an Apollo sprite, either loaded into a format::Sprite or read in
+ * place through a format::SpriteView. Either must outlive this object.
+ */
 class ApolloSprite final : public gl::Sprite {
 public:
     explicit ApolloSprite(const format::Sprite& sprite, const format::Pal& pal)
-        : sprite_{ sprite }
-        , pal_{ pal } {}
+        : Sprite(pal)
+        , sprite_{ &sprite } {}
+
+    explicit ApolloSprite(const format::SpriteView& view, const format::Pal& pal)
+        : Sprite(pal)
+        , view_{ &view } {}
 
     void load() override;
 
@@ -24,15 +33,23 @@ public:
     void advanceFrame() override;
     void recedeFrame() override;
 
-    const format::Sprite::Animation& currentAnimation() const { return sprite_.animations[anim_idx_]; }
-    const format::Sprite::Frame& currentFrame() const { return currentAnimation().frames[frame_idx_]; }
-
 private:
     void draw(int offset_x, int offset_y) const;
+    void drawLayer(unsigned int image_index, int x, int y, const Color& c, bool mirror) const;
+
+    size_t animationCount() const;
+    size_t frameCount() const;
+    int anchorX() const;
+    int anchorY() const;
+    const format::Sprite::Frame& currentSpriteFrame() const { return sprite_->animations[anim_idx_].frames[frame_idx_]; }
 
-    const format::Sprite& sprite_;
-    const format::Pal& pal_;
+    /// Looks up the current animation and frame in view_, so drawing doesn't walk its records.
+    void updateViewFrame();
 
+    const format::Sprite* sprite_ = nullptr;
+    const format::SpriteView* view_ = nullptr;
+    format::SpriteView::Animation view_anim_;
+    format::SpriteView::Frame view_frame_;
 };
 
 } // namespace gl
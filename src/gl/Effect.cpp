@@ -2,10 +2,13 @@
 
 #include <iostream>
 #include <cstring>
+#include <future>
 #include <string>
+#include <unordered_map>
 #include <glad/glad.h>
+#include "TextureManager.hpp"
 #include "../format/Image.hpp"
-#include "../util/filehandler.hpp"
+#include "../util/MappedFile.hpp"
 
 using namespace std;
 using format::Image;
@@ -34,7 +37,23 @@ static GLenum glValueFromBlendType(Str::Frame::BlendType type)
     return GL_ZERO;
 }
 
-void Effect::load(const Str& str, const char* texture_path)
+void Effect::load(const Str& str, const char* texture_path, ThreadPool& pool)
+{
+    loadTextures(str, texture_path, pool, "disk:", [](const string& filepath) {
+        return mapFile(filepath.c_str());
+    });
+}
+
+void Effect::load(const Str& str, const format::Grf& grf, const char* texture_path, ThreadPool& pool)
+{
+    loadTextures(str, texture_path, pool, "grf:" + grf.filename() + ':', [&grf](const string& filepath) {
+        return grf.read(filepath);
+    });
+}
+
+template <typename ReadFile>
+void Effect::loadTextures(const Str& str, const char* texture_path, ThreadPool& pool,
+                          const string& source, ReadFile read_file)
 {
     str_ = &str;
     string texture_path_str(texture_path);
@@ -43,30 +62,86 @@ void Effect::load(const Str& str, const char* texture_path)
     if (!strchr("/\\", texture_path[strlen(texture_path) - 1]))
         texture_path_str += '/';
 
-    for (int layer_index = 0; layer_index < str.layers.size(); layer_index++)
-    {
-        const Str::Layer& layer = str.layers[layer_index];
+    // Take textures already resident in the manager, and find the others once each
+    TextureManager& manager = TextureManager::shared();
+    unordered_map<string, shared_ptr<Texture>> textures;
+    vector<string> filepaths;
 
+    for (const Str::Layer& layer : str.layers)
+    {
         for (const Str::Texture& texture : layer.textures)
         {
             string filepath = texture_path_str + texture.filename.data();
-            
-            // Create or retrieve texture from cache
-            Texture& tex = texture_cache_[filepath];
-
-            // If texture hasn't been previously loaded, it's a new texture, so load it
-            if (!tex.width())
-            {
-                Image image(readFile(filepath.c_str()));
-                tex.load(image.width, image.height, image.channels == 3 ? Texture::Rgb : Texture::Rgba, image.pixels.get());
-            }
-
-            // Add a ref so the layer can use it
-            layer_textures_[layer_index].emplace_back(tex);
+
+            if (textures.count(filepath))
+                continue;
+
+            shared_ptr<Texture> tex = manager.find(TextureManager::key(source + filepath));
+
+            if (!tex)
+                filepaths.push_back(filepath);
+
+            textures.emplace(move(filepath), move(tex));
         }
     }
 
-    current_layer_frames_.resize(str.layers.size());
+    // Read and decode them on the pool, since only the upload needs the GL context
+    vector<Image> images(filepaths.size());
+    vector<future<void>> decoded;
+    decoded.reserve(filepaths.size());
+
+    for (size_t i = 0; i < filepaths.size(); i++)
+    {
+        decoded.push_back(pool.submit([&, i] {
+            images[i].load(read_file(filepaths[i]));
+        }));
+    }
+
+    // Upload each texture as soon as it's decoded, in order
+    try {
+        for (size_t i = 0; i < filepaths.size(); i++)
+        {
+            decoded[i].get();
+
+            Image& image = images[i];
+            Texture tex(image.width, image.height, image.channels == 3 ? Texture::Rgb : Texture::Rgba, image.pixels.get());
+            image.pixels.reset();
+
+            textures[filepaths[i]] = manager.insert(TextureManager::key(source + filepaths[i]), move(tex));
+        }
+    }
+    catch (...) {
+        // Tasks still running refer to images and filepaths
+        for (future<void>& result : decoded)
+        {
+            if (result.valid())
+                result.wait();
+        }
+
+        throw;
+    }
+
+    // Release textures of the previous str, if any
+    layer_textures_.clear();
+
+    for (int layer_index = 0; layer_index < str.layers.size(); layer_index++)
+    {
+        const Str::Layer& layer = str.layers[layer_index];
+
+        // Add a ref so the layer can use it
+        for (const Str::Texture& texture : layer.textures)
+            layer_textures_[layer_index].push_back(textures[texture_path_str + texture.filename.data()]);
+    }
+
+    layer_cursors_.clear();
+    layer_cursors_.reserve(str.layers.size());
+
+    for (const Str::Layer& layer : str.layers)
+        layer_cursors_.emplace_back(layer);
+
+    if (baked_)
+        timeline_.bake(str);
+
     updateCurrentFrames();
 }
 
@@ -85,8 +160,37 @@ void Effect::update(double dt)
 
 void Effect::draw() const
 {
-    for (int i = 0; i < str_->layers.size(); i++)
-        drawLayer(i);
+    if (baked_)
+    {
+        if (current_frame_ < 0 || static_cast<size_t>(current_frame_) >= timeline_.frameCount())
+            return;
+
+        for (const format::StrTimeline::Quad& quad : timeline_.quadsAt(current_frame_))
+            drawQuad(quad);
+
+        return;
+    }
+
+    format::StrTimeline::Quad quad;
+
+    for (uint32_t layer_index = 0; layer_index < layer_cursors_.size(); layer_index++)
+    {
+        const format::StrCursor& cursor = layer_cursors_[layer_index];
+
+        // Draw layer only if there's a frame to draw
+        if (cursor.base() && format::StrTimeline::evaluate(*str_, layer_index, *cursor.base(), cursor.morph(), current_frame_, quad))
+            drawQuad(quad);
+    }
+}
+
+void Effect::setBaked(bool baked)
+{
+    baked_ = baked;
+
+    if (!baked_)
+        timeline_ = format::StrTimeline();
+    else if (str_)
+        timeline_.bake(*str_);
 }
 
 void Effect::advanceFrame()
@@ -111,7 +215,7 @@ vector<int> Effect::activeLayers() const
 
     for (int layer_idx = 0; layer_idx < str_->layers.size(); layer_idx++)
     {
-        if (current_layer_frames_[layer_idx].base || current_layer_frames_[layer_idx].animation)
+        if (layer_cursors_[layer_idx].base() || layer_cursors_[layer_idx].morph())
             active_layers.push_back(layer_idx);
     }
 
@@ -120,126 +224,29 @@ vector<int> Effect::activeLayers() const
 
 void Effect::updateCurrentFrames()
 {
-    // Update each layer
-    for (int layer_idx = 0; layer_idx < str_->layers.size(); layer_idx++)
-    {
-        const Str::Layer& layer = str_->layers[layer_idx];
-
-        if (layer.frames.empty())
-            continue;
-
-        bool found = false;
-
-        // Each layer's frame
-        for (const Str::Frame& frame : layer.frames)
-        {
-            if (frame.frame_number > current_frame_)
-                break;
-
-            if (frame.morph) {
-                current_layer_frames_[layer_idx].animation = &frame;
-            }
-            else {
-                current_layer_frames_[layer_idx].base = &frame;
-                current_layer_frames_[layer_idx].animation = nullptr;
-            }
-
-            found = frame.frame_number == current_frame_;
-        }
-
-        if (!found && !current_layer_frames_[layer_idx].animation)
-            current_layer_frames_[layer_idx].base = nullptr;
-    }
+    for (format::StrCursor& cursor : layer_cursors_)
+        cursor.seek(static_cast<uint32_t>(current_frame_));
 }
 
-void Effect::drawLayer(int layer_index) const
+void Effect::drawQuad(const format::StrTimeline::Quad& quad) const
 {
-    // Draw layer only if there's a frame to draw
-    if (!current_layer_frames_[layer_index].base)
-        return;
-
-    const Str::Frame& base_frame = *current_layer_frames_[layer_index].base;
-
-    // Draw frame only if alpha is more than zero
-    if (base_frame.color.a == 0)
-        return;
-
-    auto textures_iter = layer_textures_.find(layer_index);
-    if (textures_iter == layer_textures_.end())
+    auto textures_iter = layer_textures_.find(quad.layer_index);
+    if (textures_iter == layer_textures_.end() || quad.texture_index >= textures_iter->second.size())
         return;
 
-    auto& textures = textures_iter->second;
-
-    // Ensure base frame's texture index is valid
-    if (base_frame.texture_index < 0 || base_frame.texture_index >= textures.size())
-        return;
-    
-    constexpr float str_angle_to_degrees = 2.8444f;
-
-    Color color = base_frame.color;
-    Point2D position = base_frame.position;
-    Rect<Point2D> drawing_rect = base_frame.drawing_rect;
-    Rect<Point2D> uv_mapping = base_frame.uv_mapping;
-    float rotation = base_frame.rz / str_angle_to_degrees;
-
-    // Translate by character size
-    //position.x += 320;
-    //position.y += 290;
-
-    // Apply a few modifications if there's an animation frame along with base frame
-    if (const Str::Frame* anim_frame = current_layer_frames_[layer_index].animation)
-    {
-        const int ani_factor = current_frame_ - anim_frame->frame_number;
-
-        // Color
-        color.r += anim_frame->color.r * ani_factor;
-        color.g += anim_frame->color.g * ani_factor;
-        color.b += anim_frame->color.b * ani_factor;
-        color.a += anim_frame->color.a * ani_factor;
-
-        // Position
-        position.x += anim_frame->position.x * ani_factor;
-        position.y += anim_frame->position.y * ani_factor;
-
-        // Drawing rect
-        drawing_rect.a.x += anim_frame->drawing_rect.a.x * ani_factor;
-        drawing_rect.a.y += anim_frame->drawing_rect.a.y * ani_factor;
-        drawing_rect.b.x += anim_frame->drawing_rect.b.x * ani_factor;
-        drawing_rect.b.y += anim_frame->drawing_rect.b.y * ani_factor;
-        drawing_rect.c.x += anim_frame->drawing_rect.c.x * ani_factor;
-        drawing_rect.c.y += anim_frame->drawing_rect.c.y * ani_factor;
-        drawing_rect.d.x += anim_frame->drawing_rect.d.x * ani_factor;
-        drawing_rect.d.y += anim_frame->drawing_rect.d.y * ani_factor;
-
-        // Texture mapping
-        uv_mapping.a.x += anim_frame->uv_mapping.a.x * ani_factor;
-        uv_mapping.a.y += anim_frame->uv_mapping.a.y * ani_factor;
-        uv_mapping.b.x += anim_frame->uv_mapping.b.x * ani_factor;
-        uv_mapping.b.y += anim_frame->uv_mapping.b.y * ani_factor;
-        uv_mapping.c.x += anim_frame->uv_mapping.c.x * ani_factor;
-        uv_mapping.c.y += anim_frame->uv_mapping.c.y * ani_factor;
-        uv_mapping.d.x += anim_frame->uv_mapping.d.x * ani_factor;
-        uv_mapping.d.y += anim_frame->uv_mapping.d.y * ani_factor;
-
-        // Rotation
-        rotation += (anim_frame->rz / str_angle_to_degrees) * ani_factor;
-    }
-
-    const Texture& texture = textures[base_frame.texture_index].get();
-
-    glPushMatrix();
+    const Texture& texture = *textures_iter->second[quad.texture_index];
+    const Rect<Point2D>& vertices = quad.vertices;
+    const Rect<Point2D>& uv_mapping = quad.uv_mapping;
 
     GLfloat current_color[4];
     glGetFloatv(GL_CURRENT_COLOR, current_color);
     
     glColor4d(1, 1, 1, 1);
-    //glColor4ub(color.r, color.g, color.b, color.a);
-    glTranslatef(position.x, position.y, 0.f);
-    glRotatef(rotation, 0.f, 0.f, 1.f);
+    //glColor4ub(quad.color.r, quad.color.g, quad.color.b, quad.color.a);
     
     glBlendFunc(
-        glValueFromBlendType(base_frame.src_blend_type),
-        glValueFromBlendType(base_frame.dest_blend_type)
+        glValueFromBlendType(quad.src_blend_type),
+        glValueFromBlendType(quad.dest_blend_type)
     );
     
     glEnable(GL_BLEND);
@@ -247,10 +254,10 @@ void Effect::drawLayer(int layer_index) const
     glColorMask(true, true, true, false);
 
     glBegin(GL_QUADS);
-    glTexCoord2f(uv_mapping.a.x, uv_mapping.a.y); glVertex3f(drawing_rect.a.x, drawing_rect.a.y, 0.f); // bottom left
-    glTexCoord2f(uv_mapping.b.x, uv_mapping.b.y); glVertex3f(drawing_rect.b.x, drawing_rect.b.y, 0.f); // bottom right
-    glTexCoord2f(uv_mapping.c.x, uv_mapping.c.y); glVertex3f(drawing_rect.c.x, drawing_rect.c.y, 0.f); // top right
-    glTexCoord2f(uv_mapping.d.x, uv_mapping.d.y); glVertex3f(drawing_rect.d.x, drawing_rect.d.y, 0.f); // top left
+    glTexCoord2f(uv_mapping.a.x, uv_mapping.a.y); glVertex3f(vertices.a.x, vertices.a.y, 0.f); // bottom left
+    glTexCoord2f(uv_mapping.b.x, uv_mapping.b.y); glVertex3f(vertices.b.x, vertices.b.y, 0.f); // bottom right
+    glTexCoord2f(uv_mapping.c.x, uv_mapping.c.y); glVertex3f(vertices.c.x, vertices.c.y, 0.f); // top right
+    glTexCoord2f(uv_mapping.d.x, uv_mapping.d.y); glVertex3f(vertices.d.x, vertices.d.y, 0.f); // top left
     glEnd();
 
     Texture::unbind();
@@ -264,10 +271,10 @@ void Effect::drawLayer(int layer_index) const
         glColor4d(1, 1, 1, 1);
 
         glBegin(GL_LINE_LOOP);
-        glVertex3f(drawing_rect.a.x, drawing_rect.a.y, 0.f); // bottom left
-        glVertex3f(drawing_rect.b.x, drawing_rect.b.y, 0.f); // bottom right
-        glVertex3f(drawing_rect.c.x, drawing_rect.c.y, 0.f); // top right
-        glVertex3f(drawing_rect.d.x, drawing_rect.d.y, 0.f); // top left
+        glVertex3f(vertices.a.x, vertices.a.y, 0.f); // bottom left
+        glVertex3f(vertices.b.x, vertices.b.y, 0.f); // bottom right
+        glVertex3f(vertices.c.x, vertices.c.y, 0.f); // top right
+        glVertex3f(vertices.d.x, vertices.d.y, 0.f); // top left
         glEnd();
     }
 
@@ -277,8 +284,6 @@ void Effect::drawLayer(int layer_index) const
         current_color[2],
         current_color[3]
     );
-
-    glPopMatrix();
 }
 
 } // namespace gl
\ No newline at end of file
@@ -1,12 +1,16 @@
 #ifndef ROTOOLS_GL_EFFECT_HPP
 #define ROTOOLS_GL_EFFECT_HPP
 
-#include <functional>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include "Texture.hpp"
+#include "../format/Grf.hpp"
 #include "../format/Str.hpp"
+#include "../format/StrCursor.hpp"
+#include "../format/StrTimeline.hpp"
+#include "../util/ThreadPool.hpp"
 
 using format::Str;
 
@@ -15,11 +19,21 @@ namespace gl {
 class Effect final {
 public:
     /**
-     * Loads from str and loads textures.
+     * Loads from str and loads textures, decoding them on pool and
+     * uploading them from the calling thread. Textures are shared with
+     * other effects through TextureManager::shared().
      *
      * @throws FileNotOpen if it fails to open a str texture.
      */
-    void load(const Str& str, const char* texture_path);
+    void load(const Str& str, const char* texture_path, ThreadPool& pool);
+
+    /**
+     * Loads from str and loads textures from a grf archive, decoding them on
+     * pool and uploading them from the calling thread.
+     *
+     * @throws InvalidResource if a str texture is not in the archive.
+     */
+    void load(const Str& str, const format::Grf& grf, const char* texture_path, ThreadPool& pool);
 
     void update(double dt);
     void draw() const;
@@ -30,6 +44,15 @@ public:
     int currentFrame() const { return current_frame_ + 1; }
     size_t frameCount() const { return str_->frame_count; }
 
+    /**
+     * Evaluates every frame of the str ahead, so drawing looks up the quads
+     * of the current frame instead of morphing keyframes, at the cost of
+     * storing each layer drawn at each frame. Takes effect immediately if
+     * loaded, otherwise on load().
+     */
+    void setBaked(bool baked);
+    bool baked() const { return baked_; }
+
     void showBorder(bool show = true) { show_border_ = show; }
     bool showingBorder() const { return show_border_; }
 
@@ -61,22 +84,26 @@ public:
     Texture::ResizeFilter minFilter() const { return min_filter_; }
 
 private:
-    struct LayerFrames {
-        const Str::Frame* base = nullptr;
-        const Str::Frame* animation = nullptr;
-    };
-
+    /**
+     * Loads textures read by read_file(filepath), which returns a MappedFile,
+     * Buffer or other BufferView. Textures are shared under source followed
+     * by their filepath, so the same path from another source isn't mixed up.
+     */
+    template <typename ReadFile>
+    void loadTextures(const Str& str, const char* texture_path, ThreadPool& pool,
+                      const std::string& source, ReadFile read_file);
     void updateCurrentFrames();
-    void drawLayer(int layer_index) const;
+    void drawQuad(const format::StrTimeline::Quad& quad) const;
 
-    std::unordered_map<std::string, Texture> texture_cache_;
-    std::unordered_map<int, std::vector<std::reference_wrapper<Texture>>> layer_textures_;
+    std::unordered_map<int, std::vector<std::shared_ptr<Texture>>> layer_textures_; // from TextureManager::shared()
     Texture::ResizeFilter mag_filter_ = Texture::Linear;
     Texture::ResizeFilter min_filter_ = Texture::LinearMipmapLinear;
 
     const Str* str_ = nullptr;
 
-    std::vector<LayerFrames> current_layer_frames_;
+    std::vector<format::StrCursor> layer_cursors_;
+    format::StrTimeline timeline_;
+    bool baked_ = false;
     int current_frame_ = 0;
     double elapsed_time_ = 0;
 
@@ -0,0 +1,123 @@
+#include "PaletteShader.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace gl {
+
+static const char* vertex_source = R"(
+#version 120
+
+void main()
+{
+    gl_TexCoord[0] = gl_MultiTexCoord0;
+    gl_FrontColor = gl_Color;
+    gl_Position = ftransform();
+}
+)";
+
+static const char* fragment_source = R"(
+#version 120
+
+uniform sampler2D indices;
+uniform sampler2D palette;
+
+void main()
+{
+    // Indices are stored normalized, so scale them back and sample texel centers
+    float index = texture2D(indices, gl_TexCoord[0].st).r;
+    vec4 color = texture2D(palette, vec2((index * 255.0 + 0.5) / 256.0, 0.5));
+    gl_FragColor = color * gl_Color;
+}
+)";
+
+static GLuint compileShader(GLenum type, const char* source)
+{
+    const GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint compiled;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+
+    if (!compiled)
+    {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        glDeleteShader(shader);
+        throw runtime_error(string("palette shader: could not compile: ") + log);
+    }
+
+    return shader;
+}
+
+static unique_ptr<PaletteShader>& sharedShader()
+{
+    static unique_ptr<PaletteShader> shader;
+    return shader;
+}
+
+const PaletteShader& PaletteShader::shared()
+{
+    unique_ptr<PaletteShader>& shader = sharedShader();
+
+    if (!shader)
+        shader = make_unique<PaletteShader>();
+
+    return *shader;
+}
+
+void PaletteShader::releaseShared()
+{
+    sharedShader().reset();
+}
+
+PaletteShader::PaletteShader()
+{
+    const GLuint vertex_shader = compileShader(GL_VERTEX_SHADER, vertex_source);
+    GLuint fragment_shader;
+
+    try {
+        fragment_shader = compileShader(GL_FRAGMENT_SHADER, fragment_source);
+    }
+    catch (...) {
+        glDeleteShader(vertex_shader);
+        throw;
+    }
+
+    program_ = glCreateProgram();
+    glAttachShader(program_, vertex_shader);
+    glAttachShader(program_, fragment_shader);
+    glLinkProgram(program_);
+
+    // The program keeps them alive as long as it needs
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+
+    GLint linked;
+    glGetProgramiv(program_, GL_LINK_STATUS, &linked);
+
+    if (!linked)
+    {
+        char log[1024];
+        glGetProgramInfoLog(program_, sizeof(log), nullptr, log);
+        glDeleteProgram(program_);
+        throw runtime_error(string("palette shader: could not link: ") + log);
+    }
+
+    // Samplers never change units
+    glUseProgram(program_);
+    glUniform1i(glGetUniformLocation(program_, "indices"), indices_unit - GL_TEXTURE0);
+    glUniform1i(glGetUniformLocation(program_, "palette"), palette_unit - GL_TEXTURE0);
+    glUseProgram(0);
+}
+
+PaletteShader::~PaletteShader()
+{
+    glDeleteProgram(program_);
+}
+
+} // namespace gl
@@ -0,0 +1,57 @@
+#ifndef ROTOOLS_GL_PALETTESHADER_HPP
+#define ROTOOLS_GL_PALETTESHADER_HPP
+
+#include <glad/glad.h>
+
+namespace gl {
+
+/**
+ * Shader program drawing palette images.
+ *
+ * The image is bound to texture unit 0 as a single-channel texture of
+ * indices, and its palette to unit 1 as a 256x1 RGBA texture. The result is
+ * modulated by the current color, as fixed-function texturing does. Only
+ * GLSL 1.20 is used, so it runs on any OpenGL 2.1 context.
+ */
+class PaletteShader final {
+public:
+    /// Texture units the shader samples from.
+    static constexpr GLenum indices_unit = GL_TEXTURE0;
+    static constexpr GLenum palette_unit = GL_TEXTURE1;
+
+    /**
+     * Shader shared by every palette sprite, built on first use. Requires a
+     * current OpenGL context.
+     *
+     * @throws std::runtime_error if the shader fails to build.
+     */
+    static const PaletteShader& shared();
+
+    /// Deletes the shared shader, if built, while its context is current. It's built again on next use.
+    static void releaseShared();
+
+    /**
+     * Compiles and links the shader. Requires a current OpenGL context.
+     *
+     * @throws std::runtime_error if the shader fails to build.
+     */
+    explicit PaletteShader();
+
+    explicit PaletteShader(const PaletteShader&) = delete;
+    void operator=(const PaletteShader&) = delete;
+
+    ~PaletteShader();
+
+    /// Makes the shader current.
+    void use() const { glUseProgram(program_); }
+
+    /// Goes back to fixed-function drawing.
+    static void unuse() { glUseProgram(0); }
+
+private:
+    GLuint program_ = 0;
+};
+
+} // namespace gl
+
+#endif // ROTOOLS_GL_PALETTESHADER_HPP
@@ -2,6 +2,7 @@
 
 #include <cmath>
 #include <glad/glad.h>
+#include "../format/PalLut.hpp"
 
 using namespace std;
 
@@ -20,36 +21,70 @@ void ROSprite::update(double dt)
 
 void ROSprite::draw(const Sprite& anchor_sprite) const
 {
-    if (const ROSprite* other = dynamic_cast<const ROSprite*>(&anchor_sprite))
-    {
-        // If there's not anchor for any of the sprites, do a simple draw
-        if (currentFrame().anchors.empty() || other->currentFrame().anchors.empty()) {
-            draw();
-            return;
-        }
+    int offset_x, offset_y;
+
+    if (anchorOffset(anchor_sprite, offset_x, offset_y))
+        draw(offset_x, offset_y);
+}
+
+FlatAct::Bounds ROSprite::currentBounds(const Sprite& anchor_sprite) const
+{
+    int offset_x, offset_y;
+
+    if (!anchorOffset(anchor_sprite, offset_x, offset_y))
+        return FlatAct::Bounds();
+
+    return currentBounds().translated(offset_x, offset_y);
+}
+
+bool ROSprite::anchorOffset(const Sprite& anchor_sprite, int& offset_x, int& offset_y) const
+{
+    const ROSprite* other = dynamic_cast<const ROSprite*>(&anchor_sprite);
+
+    if (!other)
+        return false;
 
-        // Use the first anchor of both
-        const Act::Anchor& this_anchor = currentFrame().anchors[0];
-        const Act::Anchor& other_anchor = other->currentFrame().anchors[0];
+    const Span<const FlatAct::Anchor> this_anchors = act_.anchorsOf(currentFrame());
+    const Span<const FlatAct::Anchor> other_anchors = other->act_.anchorsOf(other->currentFrame());
 
-        draw(other_anchor.x - this_anchor.x, other_anchor.y - this_anchor.y);
+    // If there's not anchor for any of the sprites, do a simple draw
+    if (this_anchors.empty() || other_anchors.empty()) {
+        offset_x = offset_y = 0;
+        return true;
     }
+
+    // Use the first anchor of both
+    const FlatAct::Anchor& this_anchor = this_anchors[0];
+    const FlatAct::Anchor& other_anchor = other_anchors[0];
+
+    offset_x = other_anchor.x - this_anchor.x;
+    offset_y = other_anchor.y - this_anchor.y;
+    return true;
 }
 
 void ROSprite::draw(int offset_x, int offset_y) const
 {
-    for (const Act::Image& image : currentFrame().images)
+    beginDraw();
+
+    for (const FlatAct::Image& image : act_.imagesOf(currentFrame()))
     {
-        if (image.index < 0 || image.index >= spr_.palette_images.size())
+        // Only palette images are loaded as textures
+        if (image.index < 0 || image.index >= spr_.palette_images.size() || image.is_rgba)
             continue;
 
         const Color& c = image.color;
         const int w = spr_.palette_images[image.index].width;
         const int h = spr_.palette_images[image.index].height;
-        const int x = image.x - static_cast<int>(round(w / 2.0)) + offset_x;
-        const int y = image.y - static_cast<int>(round(h / 2.0)) + offset_y;
+        const int x = -static_cast<int>(round(w / 2.0));
+        const int y = -static_cast<int>(round(h / 2.0));
 
-        textures_[image.index].bind();
+        textures_[image.index]->bind();
+
+        // Center on the image's position, then rotate and scale around it
+        glPushMatrix();
+        glTranslated(image.x + offset_x, image.y + offset_y, 0);
+        glRotated(image.rotation, 0, 0, 1);
+        glScaled(image.scale_x, image.scale_y, 1);
 
         glBegin(GL_QUADS);
         glColor4f(c.r / 255, c.g / 255, c.b / 255, c.a / 255);
@@ -61,9 +96,10 @@ void ROSprite::draw(int offset_x, int offset_y) const
         glTexCoord2d(image.mirror ? 0 : 1, 0); glVertex3d(x+w, y,   0); // top right
         
         glEnd();
+        glPopMatrix();
     }
 
-    Texture::unbind();
+    endDraw();
 }
 
 void ROSprite::advanceAnimation()
@@ -84,44 +120,31 @@ void ROSprite::recedeAnimation()
 
 void ROSprite::advanceFrame()
 {
-    if (++frame_idx_ >= currentAnimation().frames.size())
+    if (++frame_idx_ >= currentAnimation().frames.count)
         frame_idx_ = 0;
 }
 
 void ROSprite::recedeFrame()
 {
     if (--frame_idx_ < 0)
-        frame_idx_ = currentAnimation().frames.size() - 1;
+        frame_idx_ = currentAnimation().frames.count - 1;
 }
 
 void ROSprite::load()
 {
+    frame_bounds_ = act_.frameBounds(spr_);
+
+    // First palette color is the transparency color.
+    const format::PalLut lut(*pal_, format::PalLut::KeyedFirstColor);
+    vector<uint8_t> pixels;
+
+    loadPalette(lut);
+
     // Create textures for each palette image
     for (const Spr::PaletteImage& img : spr_.palette_images)
     {
-        // First palette color is the transparency color.
-        const Color& transp_color = pal_.colors[0];
-        vector<uint8_t> pixels(img.indices.size() * 4);
-
-        for (int i = 0; i < img.indices.size(); i++)
-        {
-            uint8_t index = img.indices[i];
-            const Color& color = pal_.colors[index];
-
-            pixels[i*4 + 0] = color.r;
-            pixels[i*4 + 1] = color.g;
-            pixels[i*4 + 2] = color.b;
-            pixels[i*4 + 3] =
-                color.r == transp_color.r &&
-                color.g == transp_color.g &&
-                color.b == transp_color.b ?
-                0 : 255;
-        }
-
-        Texture texture(img.width, img.height, Texture::Rgba, pixels.data());
-        texture.setMagFilter(mag_filter_);
-
-        textures_.emplace_back(std::move(texture));
+        if (!addSharedTexture())
+            addTexture(img.width, img.height, img.indices.data(), lut, pixels);
     }
 }
 
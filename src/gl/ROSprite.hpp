@@ -2,11 +2,11 @@
 #define ROTOOLS_GL_ROSPRITE_HPP
 
 #include "Sprite.hpp"
-#include "../format/Act.hpp"
+#include "../format/FlatAct.hpp"
 #include "../format/Pal.hpp"
 #include "../format/Spr.hpp"
 
-using format::Act;
+using format::FlatAct;
 using format::Spr;
 using format::Pal;
 
@@ -14,10 +14,10 @@ namespace gl {
 
 class ROSprite final : public Sprite {
 public:
-    explicit ROSprite(const Act& act, const Spr& spr, const Pal& pal)
-        : act_{ act }
-        , spr_{ spr }
-        , pal_{ pal } {}
+    explicit ROSprite(const FlatAct& act, const Spr& spr, const Pal& pal)
+        : Sprite(pal)
+        , act_{ act }
+        , spr_{ spr } {}
 
     void load() override;
 
@@ -30,15 +30,24 @@ public:
     void advanceFrame() override;
     void recedeFrame() override;
 
-    const Act::Animation& currentAnimation() const { return act_.animations[anim_idx_]; }
-    const Act::Frame& currentFrame() const { return currentAnimation().frames[frame_idx_]; }
+    const FlatAct::Animation& currentAnimation() const { return act_.animations[anim_idx_]; }
+    const FlatAct::Frame& currentFrame() const { return act_.frames[currentAnimation().frames.offset + frame_idx_]; }
+
+    /// Bounds of the current frame, relative to where it's drawn. Computed once by load().
+    const FlatAct::Bounds& currentBounds() const { return frame_bounds_[currentAnimation().frames.offset + frame_idx_]; }
+
+    /// Bounds of the current frame when drawn anchored to anchor_sprite, empty if it isn't drawn.
+    FlatAct::Bounds currentBounds(const Sprite& anchor_sprite) const;
 
 private:
     void draw(int offset_x, int offset_y) const;
 
-    const Act& act_;
+    /// Offset at which the current frame is drawn when anchored to anchor_sprite, or false if it isn't drawn.
+    bool anchorOffset(const Sprite& anchor_sprite, int& offset_x, int& offset_y) const;
+
+    const FlatAct& act_;
     const Spr& spr_;
-    const Pal& pal_;
+    std::vector<FlatAct::Bounds> frame_bounds_;
 };
 
 } // namespace gl
@@ -0,0 +1,14 @@
+#include "SharedResources.hpp"
+
+#include "PaletteShader.hpp"
+#include "TextureManager.hpp"
+
+namespace gl {
+
+SharedResources::~SharedResources()
+{
+    TextureManager::shared().clear();
+    PaletteShader::releaseShared();
+}
+
+} // namespace gl
@@ -0,0 +1,25 @@
+#ifndef ROTOOLS_GL_SHAREDRESOURCES_HPP
+#define ROTOOLS_GL_SHAREDRESOURCES_HPP
+
+namespace gl {
+
+/**
+ * Releases process-wide OpenGL resources, i.e. TextureManager::shared()
+ * textures and PaletteShader::shared(), when destroyed.
+ *
+ * Those outlive main() otherwise, after the context they belong to is gone.
+ * Declare it as the first member of the window, so it's destroyed after the
+ * members holding shared textures but before the window closes its context.
+ */
+class SharedResources final {
+public:
+    SharedResources() = default;
+    ~SharedResources();
+
+    SharedResources(const SharedResources&) = delete;
+    SharedResources& operator=(const SharedResources&) = delete;
+};
+
+} // namespace gl
+
+#endif // ROTOOLS_GL_SHAREDRESOURCES_HPP
@@ -0,0 +1,120 @@
+#include "Sprite.hpp"
+
+#include "PaletteShader.hpp"
+#include "TextureManager.hpp"
+
+using namespace std;
+
+namespace gl {
+
+void Sprite::setPalette(const format::Pal& pal)
+{
+    pal_ = &pal;
+
+    // Not loaded yet
+    if (textures_.empty())
+        return;
+
+    if (palette_texture_) {
+        loadPalette(format::PalLut(pal, format::PalLut::KeyedFirstColor));
+        return;
+    }
+
+    textures_.clear();
+    load();
+}
+
+void Sprite::loadPalette(const format::PalLut& lut)
+{
+    if (!palette_mode_) {
+        palette_texture_.reset();
+        return;
+    }
+
+    if (!palette_texture_)
+        palette_texture_ = make_unique<Texture>();
+
+    palette_texture_->load(256, 1, Texture::Rgba, lut.data());
+    palette_texture_->setResizeFilters(Texture::Nearest, Texture::Nearest);
+}
+
+bool Sprite::addSharedTexture()
+{
+    const string key = nextTextureKey();
+
+    if (key.empty())
+        return false;
+
+    shared_ptr<Texture> texture = TextureManager::shared().find(key);
+
+    if (!texture)
+        return false;
+
+    textures_.push_back(std::move(texture));
+    return true;
+}
+
+void Sprite::addTexture(unsigned int width, unsigned int height, const uint8_t* indices,
+                        const format::PalLut& lut, vector<uint8_t>& pixels)
+{
+    Texture texture;
+
+    if (palette_mode_)
+    {
+        texture.load(width, height, Texture::Gray, indices);
+        texture.setResizeFilters(Texture::Nearest, Texture::Nearest);
+    }
+    else
+    {
+        const size_t count = static_cast<size_t>(width) * height;
+        pixels.resize(count * 4);
+        lut.expand(indices, count, pixels.data());
+
+        texture.load(width, height, Texture::Rgba, pixels.data());
+        texture.setMagFilter(mag_filter_);
+    }
+
+    const string key = nextTextureKey();
+
+    if (key.empty())
+        textures_.push_back(make_shared<Texture>(std::move(texture)));
+    else
+        textures_.push_back(TextureManager::shared().insert(key, std::move(texture)));
+}
+
+string Sprite::nextTextureKey() const
+{
+    if (source_path_.empty())
+        return string();
+
+    // Indices don't depend on the palette
+    return TextureManager::key(source_path_ + ':' + to_string(textures_.size()), palette_mode_ ? nullptr : pal_);
+}
+
+void Sprite::beginDraw() const
+{
+    if (!palette_texture_)
+        return;
+
+    PaletteShader::shared().use();
+
+    glActiveTexture(PaletteShader::palette_unit);
+    palette_texture_->bind();
+    glActiveTexture(PaletteShader::indices_unit);
+}
+
+void Sprite::endDraw() const
+{
+    Texture::unbind();
+
+    if (!palette_texture_)
+        return;
+
+    glActiveTexture(PaletteShader::palette_unit);
+    Texture::unbind();
+    glActiveTexture(PaletteShader::indices_unit);
+
+    PaletteShader::unuse();
+}
+
+} // namespace gl
@@ -1,14 +1,19 @@
 #ifndef ROTOOLS_GL_SPRITE_HPP
 #define ROTOOLS_GL_SPRITE_HPP
 
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 #include "Texture.hpp"
+#include "../format/Pal.hpp"
+#include "../format/PalLut.hpp"
 
 namespace gl {
 
 class Sprite {
 public:
-    explicit Sprite() = default;
+    explicit Sprite(const format::Pal& pal) : pal_{ &pal } {}
     explicit Sprite(Sprite&&) = default;
     virtual ~Sprite() = default;
 
@@ -26,6 +31,33 @@ public:
     int currentAnimationIndex() const { return anim_idx_; }
     int currentFrameIndex() const { return frame_idx_; }
     
+    /**
+     * Uploads images as 8-bit indices and the palette as a 256x1 texture,
+     * resolved by PaletteShader when drawing, instead of expanding images
+     * to RGBA. Images take a quarter of the memory, palette swaps upload 1 KB
+     * and filters are always Nearest, since blending indices is meaningless.
+     * Takes effect on the next load().
+     */
+    void setPaletteMode(bool enabled) { palette_mode_ = enabled; }
+    bool paletteMode() const { return palette_mode_; }
+
+    /**
+     * Changes the palette, which must outlive the sprite. If loaded in
+     * palette mode, only the palette texture is uploaded again, otherwise
+     * every image is reloaded.
+     */
+    void setPalette(const format::Pal& pal);
+    const format::Pal& palette() const { return *pal_; }
+
+    /**
+     * Sets the file images are loaded from, so their textures are shared
+     * through TextureManager::shared() with every sprite loaded from it with
+     * the same palette, or in palette mode. Shared textures keep the filters
+     * they were last set to by any sprite. Takes effect on the next load().
+     */
+    void setSourcePath(std::string path) { source_path_ = std::move(path); }
+    const std::string& sourcePath() const { return source_path_; }
+
     void setMagFilter(Texture::ResizeFilter filter)
     {
         if (filter == mag_filter_)
@@ -33,8 +65,11 @@ public:
 
         mag_filter_ = filter;
 
-        for (Texture& texture : textures_)
-            texture.setMagFilter(filter);
+        if (palette_mode_)
+            return;
+
+        for (const std::shared_ptr<Texture>& texture : textures_)
+            texture->setMagFilter(filter);
     }
 
     void setMinFilter(Texture::ResizeFilter filter)
@@ -44,15 +79,41 @@ public:
 
         min_filter_ = filter;
 
-        for (Texture& texture : textures_)
-            texture.setMinFilter(filter);
+        if (palette_mode_)
+            return;
+
+        for (const std::shared_ptr<Texture>& texture : textures_)
+            texture->setMinFilter(filter);
     }
 
     Texture::ResizeFilter magFilter() const { return mag_filter_; }
     Texture::ResizeFilter minFilter() const { return min_filter_; }
 
 protected:
-    std::vector<Texture> textures_;
+    /// Uploads the palette texture from lut if in palette mode.
+    void loadPalette(const format::PalLut& lut);
+
+    /// Appends the texture of the next image from the texture manager if it's resident there, so it needn't be decoded.
+    bool addSharedTexture();
+
+    /// Appends the texture of a palette image, expanding it through lut into pixels unless in palette mode.
+    void addTexture(unsigned int width, unsigned int height, const uint8_t* indices,
+                    const format::PalLut& lut, std::vector<uint8_t>& pixels);
+
+    /// Prepares the palette shader and texture if in palette mode. Image textures are then bound as usual.
+    void beginDraw() const;
+
+    /// Goes back to fixed-function drawing.
+    void endDraw() const;
+
+    /// Key of the next image's texture in the texture manager, empty if not shared.
+    std::string nextTextureKey() const;
+
+    const format::Pal* pal_;
+    std::vector<std::shared_ptr<Texture>> textures_;
+    std::unique_ptr<Texture> palette_texture_;
+    bool palette_mode_ = false;
+    std::string source_path_;
     Texture::ResizeFilter mag_filter_ = Texture::Linear;
     Texture::ResizeFilter min_filter_ = Texture::LinearMipmapLinear;
 
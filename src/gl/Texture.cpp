@@ -24,6 +24,7 @@ void Texture::load(unsigned int width, unsigned int height, Format format, const
 
     switch (format)
     {
+        case Format::Gray: gl_format = GL_LUMINANCE; break;
         case Format::Red: gl_format = GL_RED; break;
         case Format::Rgb: gl_format = GL_RGB; break;
         case Format::Rgba: gl_format = GL_RGBA; break;
@@ -32,6 +33,9 @@ void Texture::load(unsigned int width, unsigned int height, Format format, const
     }
 
     bind();
+
+    // Rows are tightly packed, whatever their size
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glTexImage2D(GL_TEXTURE_2D, 0, gl_format, width, height, 0, gl_format, GL_UNSIGNED_BYTE, data);
     glGenerateMipmap(GL_TEXTURE_2D);
 
@@ -42,6 +46,24 @@ void Texture::load(unsigned int width, unsigned int height, Format format, const
 
     width_ = width;
     height_ = height;
+    format_ = format;
+}
+
+size_t Texture::byteSize() const
+{
+    size_t channels = 4;
+
+    switch (format_)
+    {
+        case Format::Gray:
+        case Format::Red: channels = 1; break;
+        case Format::Rgb: channels = 3; break;
+        case Format::Rgba: channels = 4; break;
+    }
+
+    // Mipmaps add a third to the base level
+    const size_t base = static_cast<size_t>(width_) * height_ * channels;
+    return base + base / 3;
 }
 
 void Texture::setMinFilter(ResizeFilter filter) const
@@ -74,7 +96,7 @@ void Texture::setResizeFilters(ResizeFilter mag_filter, ResizeFilter min_filter)
     {
         bind();
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_param);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_param);
     }
 }
 
@@ -1,6 +1,7 @@
 #ifndef ROTOOLS_GL_TEXTURE_HPP
 #define ROTOOLS_GL_TEXTURE_HPP
 
+#include <cstddef>
 #include <utility>
 #include <glad/glad.h>
 
@@ -41,7 +42,8 @@ public:
     explicit Texture(Texture&& other)
         : id_{ std::exchange(other.id_, 0) }
         , width_{ std::exchange(other.width_, 0) }
-        , height_{ std::exchange(other.height_, 0) } {}
+        , height_{ std::exchange(other.height_, 0) }
+        , format_{ other.format_ } {}
 
     /// no copy contructor
     explicit Texture(const Texture&) = delete;
@@ -72,6 +74,10 @@ public:
 
     int width() const { return width_; }
     int height() const { return height_; }
+    Format format() const { return format_; }
+
+    /// Estimated video memory taken by the texture and its mipmaps.
+    size_t byteSize() const;
 
     // Move assignment.
     Texture& operator=(Texture&& other)
@@ -79,6 +85,7 @@ public:
         id_ = std::exchange(other.id_, 0);
         width_ = std::exchange(other.width_, 0);
         height_ = std::exchange(other.height_, 0);
+        format_ = other.format_;
         return *this;
     }
 
@@ -89,6 +96,7 @@ private:
     GLuint id_ = 0;
     int width_ = 0;
     int height_ = 0;
+    Format format_ = Rgba;
 };
 
 } // namespace gl
@@ -0,0 +1,151 @@
+#include "TextureManager.hpp"
+
+#include <cstdio>
+
+using namespace std;
+
+namespace gl {
+
+TextureManager& TextureManager::shared()
+{
+    static TextureManager manager;
+    return manager;
+}
+
+string TextureManager::key(string_view path, const format::Pal* pal)
+{
+    string key(path);
+
+    if (!pal)
+        return key;
+
+    // FNV-1a of the palette colors
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (const Color& color : pal->colors)
+    {
+        for (const uint8_t byte : { color.r, color.g, color.b, color.a })
+            hash = (hash ^ byte) * 0x100000001b3ULL;
+    }
+
+    char suffix[18];
+    snprintf(suffix, sizeof(suffix), "#%016llx", static_cast<unsigned long long>(hash));
+    return key + suffix;
+}
+
+shared_ptr<Texture> TextureManager::find(const string& key)
+{
+    auto entry_iter = entries_.find(key);
+
+    if (entry_iter == entries_.end()) {
+        misses_++;
+        return nullptr;
+    }
+
+    // Move to the front of the LRU list
+    Entry& entry = entry_iter->second;
+    lru_.splice(lru_.begin(), lru_, entry.lru_pos);
+
+    hits_++;
+    return entry.texture;
+}
+
+shared_ptr<Texture> TextureManager::insert(const string& key, Texture&& texture)
+{
+    auto entry_iter = entries_.find(key);
+
+    if (entry_iter != entries_.end())
+        evict(entry_iter);
+
+    Entry entry;
+    entry.texture = make_shared<Texture>(std::move(texture));
+    entry.bytes = entry.texture->byteSize();
+    entry.lru_pos = lru_.insert(lru_.begin(), key);
+
+    resident_bytes_ += entry.bytes;
+
+    shared_ptr<Texture> result = entry.texture;
+    entries_.emplace(key, std::move(entry));
+
+    trim();
+    return result;
+}
+
+shared_ptr<Texture> TextureManager::acquire(const string& key, const function<void(Texture&)>& load)
+{
+    if (shared_ptr<Texture> texture = find(key))
+        return texture;
+
+    Texture texture;
+    load(texture);
+    return insert(key, std::move(texture));
+}
+
+void TextureManager::setBudget(size_t bytes)
+{
+    budget_ = bytes;
+    trim();
+}
+
+void TextureManager::trim()
+{
+    // Candidates are just before pos, going from the least recently used
+    auto pos = lru_.end();
+
+    while (resident_bytes_ > budget_ && pos != lru_.begin())
+    {
+        const auto candidate = std::prev(pos);
+        const auto entry_iter = entries_.find(*candidate);
+
+        // Only referenced by the manager
+        if (entry_iter->second.texture.use_count() == 1) {
+            evict(entry_iter);
+            evictions_++;
+        }
+        else {
+            pos = candidate;
+        }
+    }
+}
+
+void TextureManager::clear()
+{
+    for (auto entry_iter = entries_.begin(); entry_iter != entries_.end();)
+    {
+        const auto next = std::next(entry_iter);
+
+        if (entry_iter->second.texture.use_count() == 1) {
+            evict(entry_iter);
+            evictions_++;
+        }
+
+        entry_iter = next;
+    }
+}
+
+TextureManager::Stats TextureManager::stats() const
+{
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.resident_count = entries_.size();
+    stats.resident_bytes = resident_bytes_;
+
+    for (const auto& [key, entry] : entries_)
+    {
+        if (entry.texture.use_count() > 1)
+            stats.referenced_bytes += entry.bytes;
+    }
+
+    return stats;
+}
+
+void TextureManager::evict(unordered_map<string, Entry>::iterator entry_iter)
+{
+    resident_bytes_ -= entry_iter->second.bytes;
+    lru_.erase(entry_iter->second.lru_pos);
+    entries_.erase(entry_iter);
+}
+
+} // namespace gl
@@ -0,0 +1,99 @@
+#ifndef ROTOOLS_GL_TEXTUREMANAGER_HPP
+#define ROTOOLS_GL_TEXTUREMANAGER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "Texture.hpp"
+#include "../format/Pal.hpp"
+
+namespace gl {
+
+/**
+ * Textures shared by key, usually a source path plus the palette it was
+ * expanded with, so assets used by several sprites or effects are uploaded
+ * once.
+ *
+ * Textures stay resident while referenced. Unreferenced ones are kept for
+ * reuse as long as resident textures fit the budget, then evicted least
+ * recently used first. Referenced textures are never evicted, even over
+ * budget. Not thread-safe; use it from the thread owning the OpenGL context.
+ */
+class TextureManager final {
+public:
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t resident_count = 0;
+        size_t resident_bytes = 0;   // estimated, see Texture::byteSize()
+        size_t referenced_bytes = 0; // of resident textures in use
+    };
+
+    static constexpr size_t default_budget = 256 * 1024 * 1024;
+
+    /// Manager shared by the whole process.
+    static TextureManager& shared();
+
+    /// Key of a texture loaded from path, expanded through pal if not null.
+    static std::string key(std::string_view path, const format::Pal* pal = nullptr);
+
+    explicit TextureManager(size_t budget = default_budget) : budget_{ budget } {}
+
+    explicit TextureManager(const TextureManager&) = delete;
+    void operator=(const TextureManager&) = delete;
+
+    /// Resident texture of key, or null if there's none.
+    std::shared_ptr<Texture> find(const std::string& key);
+
+    /// Makes texture resident under key, replacing any previous one, and evicts textures over budget.
+    std::shared_ptr<Texture> insert(const std::string& key, Texture&& texture);
+
+    /// Resident texture of key, or a new texture loaded by load and inserted.
+    std::shared_ptr<Texture> acquire(const std::string& key, const std::function<void(Texture&)>& load);
+
+    /// Sets how many bytes unreferenced textures may keep resident, evicting any over it.
+    void setBudget(size_t bytes);
+    size_t budget() const { return budget_; }
+
+    /// Evicts unreferenced textures, least recently used first, until resident textures fit the budget.
+    void trim();
+
+    /// Evicts every unreferenced texture.
+    void clear();
+
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<Texture> texture;
+        size_t bytes;
+        std::list<std::string>::iterator lru_pos;
+    };
+
+    void evict(std::unordered_map<std::string, Entry>::iterator entry_iter);
+
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> lru_; // keys, most recently used first
+    size_t budget_;
+    size_t resident_bytes_ = 0;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+    size_t evictions_ = 0;
+};
+
+inline std::ostream& operator<<(std::ostream& out, const TextureManager::Stats& stats)
+{
+    return out << "textures: " << stats.resident_count << " resident (" << stats.resident_bytes / 1024 << " KiB, "
+               << stats.referenced_bytes / 1024 << " KiB in use), " << stats.hits << " hits, "
+               << stats.misses << " misses, " << stats.evictions << " evictions";
+}
+
+} // namespace gl
+
+#endif // ROTOOLS_GL_TEXTUREMANAGER_HPP
@@ -1,100 +1,107 @@
 #ifndef RO_BUFFER_HPP
 #define RO_BUFFER_HPP
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#include <stdexcept>
+#include "BufferView.hpp"
 
-class Buffer {
+class Buffer : public BufferView {
 public:
     /// Constructs a new buffer with a given size.
-    explicit Buffer(size_t size = 0) { data_.resize(size); }
+    explicit Buffer(size_t size = 0) { data_.resize(size); sync(); }
 
     /// Constructs from a memory pointer and becomes its owner.
     explicit Buffer(std::vector<uint8_t> data) noexcept
-        : data_{ std::move(data) } {}
+        : data_{ std::move(data) } { sync(); }
 
-    /// Pointer to the data.
-    uint8_t* data() noexcept { return data_.data(); }
-
-    /// Const pointer to the data.
-    const uint8_t* data() const noexcept { return data_.data(); }
+    /// Copy constructor.
+    Buffer(const Buffer& other)
+        : BufferView(other)
+        , data_{ other.data_ } { sync(); }
 
-    /// Size of the buffer.
-    size_t size() const noexcept { return data_.size(); }
+    /// Move constructor.
+    Buffer(Buffer&& other) noexcept
+        : BufferView(other)
+        , data_{ std::move(other.data_) }
+    {
+        sync();
+        other.current_idx_ = 0;
+        other.sync();
+    }
 
-    /// Number of bytes remaining before the end of the buffer.
-    size_t remaining() const noexcept { return size() - current_idx_; }
+    /// Copy assignment.
+    Buffer& operator=(const Buffer& other)
+    {
+        data_ = other.data_;
+        current_idx_ = other.current_idx_;
+        sync();
+        return *this;
+    }
 
-    /**
-     * Reads n bytes into dest.
-     *
-     * @throws std::out_of_range if n exceeds buffer range.
-     */
-    void read(void* dest, size_t n) const
+    /// Move assignment.
+    Buffer& operator=(Buffer&& other) noexcept
     {
-        checkRange(n);
-        std::memcpy(dest, &data_[current_idx_], n);
-        current_idx_ += n;
+        data_ = std::move(other.data_);
+        current_idx_ = std::exchange(other.current_idx_, 0);
+        sync();
+        other.sync();
+        return *this;
     }
 
+    using BufferView::data;
+
+    /// Pointer to the data.
+    uint8_t* data() noexcept { return data_.data(); }
+
     /// Writes n bytes from src into the buffer, allocating space as needed.
     void write(const void* src, size_t n)
     {
-        try {
-            // Check whether there's available space for writing in the next n positions.
-            checkRange(n);
-        }
-        catch (const std::out_of_range&) {
-            grow(n);
-        }
-
-        std::memcpy(&data_[current_idx_], src, n);
+        ensure(n);
+        std::memcpy(data_.data() + current_idx_, src, n);
         current_idx_ += n;
     }
 
+    /// Writes count values of a trivially copyable type, allocating space as needed.
+    template <typename T>
+    void writeArray(const T* src, size_t count)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "type is not trivially copyable");
+
+        if (count)
+            write(src, count * sizeof(T));
+    }
+
     /**
      * Increases the buffer's size in n bytes.
      *
+     * Capacity grows geometrically, so repeated small increases are amortized.
+     *
      * @throws std::bad_alloc if allocation fails.
      */
-    void grow(size_t n) { data_.resize(size() + n); }
+    void grow(size_t n)
+    {
+        const size_t new_size = size() + n;
+
+        if (new_size > data_.capacity())
+            data_.reserve(std::max(new_size, data_.capacity() * 2));
+
+        data_.resize(new_size);
+        sync();
+    }
 
     /**
-     * Skips n bytes of data.
+     * Preallocates memory for a total of n bytes without changing the size.
      *
-     * @throws std::out_of_range if n exceeds buffer range.
+     * @throws std::bad_alloc if allocation fails.
      */
-    void skip(size_t n) const
-    {
-        checkRange(n);
-        current_idx_ += n;
-    }
+    void reserve(size_t n) { data_.reserve(n); sync(); }
 
-    /// Reads numbers with range checking.
-    uint8_t  readUint8()  const { return readNumber<uint8_t>(); }
-    uint16_t readUint16() const { return readNumber<uint16_t>(); }
-    uint32_t readUint32() const { return readNumber<uint32_t>(); }
-    uint64_t readUint64() const { return readNumber<uint64_t>(); }
-    int8_t   readInt8()   const { return static_cast<int8_t>(readUint8()); }
-    int16_t  readInt16()  const { return static_cast<int16_t>(readUint16()); }
-    int32_t  readInt32()  const { return static_cast<int32_t>(readUint32()); }
-    int64_t  readInt64()  const { return static_cast<int64_t>(readUint64()); }
-    float    readFloat()  const { return readNumber<float>(); }
-    double   readDouble() const { return readNumber<double>(); }
-
-    /// Reads numbers without range checking.
-    uint8_t  getUint8()  const noexcept { return getNumber<uint8_t>(); }
-    uint16_t getUint16() const noexcept { return getNumber<uint16_t>(); }
-    uint32_t getUint32() const noexcept { return getNumber<uint32_t>(); }
-    uint64_t getUint64() const noexcept { return getNumber<uint64_t>(); }
-    int8_t   getInt8()   const noexcept { return static_cast<int8_t>(getUint8()); }
-    int16_t  getInt16()  const noexcept { return static_cast<int16_t>(getUint16()); }
-    int32_t  getInt32()  const noexcept { return static_cast<int32_t>(getUint32()); }
-    int64_t  getInt64()  const noexcept { return static_cast<int64_t>(getUint64()); }
-    float    getFloat()  const noexcept { return getNumber<float>(); }
-    double   getDouble() const noexcept { return getNumber<double>(); }
+    /// Number of bytes that can be held without reallocating.
+    size_t capacity() const noexcept { return data_.capacity(); }
 
     /// Writes numbers allocating memory as needed.
     void writeUint8(uint8_t value)   { writeNumber<uint8_t>(value); }
@@ -121,34 +128,11 @@ public:
     void setDouble(double value)   noexcept { setNumber<double>(value); }
 
 private:
-    /// Generic throwing numeric read function.
-    template <typename Number>
-    Number readNumber() const
-    {
-        checkRange(sizeof(Number));
-        return getNumber<Number>();
-    }
-
-    /// Generic non-throwing numeric read function.
-    template <typename Number>
-    Number getNumber() const noexcept
-    {
-        Number value = *reinterpret_cast<const Number*>(&data_[current_idx_]);
-        current_idx_ += sizeof(Number);
-        return value;
-    }
-
     /// Generic buffer-growing numeric write function.
     template <typename Number>
     void writeNumber(Number value)
     {
-        try {
-            checkRange(sizeof(Number));
-        }
-        catch (const std::out_of_range&) {
-            grow(sizeof(Number));
-        }
-
+        ensure(sizeof(Number));
         setNumber<Number>(value);
     }
 
@@ -156,18 +140,21 @@ private:
     template <typename Number>
     void setNumber(Number value) noexcept
     {
-        *reinterpret_cast<Number*>(&data_[current_idx_]) = value;
+        std::memcpy(&data_[current_idx_], &value, sizeof(Number));
         current_idx_ += sizeof(Number);
     }
 
-    /// Throws an std::out_of_range exception if trying to access an index beyond buffer range.
-    void checkRange(size_t n) const { data_.at(current_idx_ + n - 1); }
+    /// Grows the buffer so that the next n bytes from the cursor are writable.
+    void ensure(size_t n)
+    {
+        if (n > remaining())
+            grow(n - remaining());
+    }
+
+    /// Points the view part at the owned storage, which may have been reallocated.
+    void sync() noexcept { reset(data_.data(), data_.size()); }
 
     std::vector<uint8_t> data_;
-    mutable size_t current_idx_ = 0;
 };
 
-static_assert(sizeof(float) == 4, "float size is not 4 bytes");
-static_assert(sizeof(double) == 8, "double size is not 8 bytes");
-
 #endif // RO_BUFFER_HPP
\ No newline at end of file
@@ -0,0 +1,174 @@
+#ifndef RO_BUFFERVIEW_HPP
+#define RO_BUFFERVIEW_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * Read-only cursor over memory it does not own.
+ *
+ * The viewed memory must outlive the view. Buffer and MappedFile are views
+ * over their own storage, so every loader taking a BufferView accepts both.
+ */
+class BufferView {
+public:
+    /// Constructs an empty view.
+    explicit BufferView() noexcept = default;
+
+    /// Constructs a view over size bytes starting at data.
+    explicit BufferView(const void* data, size_t size) noexcept
+        : view_data_{ static_cast<const uint8_t*>(data) }
+        , view_size_{ size } {}
+
+    /// Const pointer to the data.
+    const uint8_t* data() const noexcept { return view_data_; }
+
+    /// Size of the viewed memory.
+    size_t size() const noexcept { return view_size_; }
+
+    /// Current cursor position.
+    size_t tell() const noexcept { return current_idx_; }
+
+    /// Number of bytes remaining before the end of the view.
+    size_t remaining() const noexcept { return size() - current_idx_; }
+
+    /**
+     * Moves the cursor to an absolute position.
+     *
+     * @throws std::out_of_range if pos exceeds view range.
+     */
+    void seek(size_t pos) const
+    {
+        if (pos > size())
+            throw std::out_of_range("buffer: seek beyond end");
+
+        current_idx_ = pos;
+    }
+
+    /**
+     * Reads n bytes into dest.
+     *
+     * @throws std::out_of_range if n exceeds view range.
+     */
+    void read(void* dest, size_t n) const
+    {
+        checkRange(n);
+        std::memcpy(dest, view_data_ + current_idx_, n);
+        current_idx_ += n;
+    }
+
+    /**
+     * Ensures the next n bytes can be read, so a whole record may then be
+     * consumed with the non-checking get functions.
+     *
+     * @throws std::out_of_range if n exceeds view range.
+     */
+    void require(size_t n) const { checkRange(n); }
+
+    /**
+     * Reads count values of a trivially copyable type into dest.
+     *
+     * @throws std::out_of_range if count values exceed view range.
+     */
+    template <typename T>
+    void readArray(T* dest, size_t count) const
+    {
+        if (count > remaining() / sizeof(T))
+            throw std::out_of_range("buffer: access beyond end");
+
+        getArray(dest, count);
+    }
+
+    /// Reads count values of a trivially copyable type into dest without range checking.
+    template <typename T>
+    void getArray(T* dest, size_t count) const noexcept
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "type is not trivially copyable");
+
+        if (!count)
+            return;
+
+        std::memcpy(dest, view_data_ + current_idx_, count * sizeof(T));
+        current_idx_ += count * sizeof(T);
+    }
+
+    /**
+     * Skips n bytes of data.
+     *
+     * @throws std::out_of_range if n exceeds view range.
+     */
+    void skip(size_t n) const
+    {
+        checkRange(n);
+        current_idx_ += n;
+    }
+
+    /// Reads numbers with range checking.
+    uint8_t  readUint8()  const { return readNumber<uint8_t>(); }
+    uint16_t readUint16() const { return readNumber<uint16_t>(); }
+    uint32_t readUint32() const { return readNumber<uint32_t>(); }
+    uint64_t readUint64() const { return readNumber<uint64_t>(); }
+    int8_t   readInt8()   const { return static_cast<int8_t>(readUint8()); }
+    int16_t  readInt16()  const { return static_cast<int16_t>(readUint16()); }
+    int32_t  readInt32()  const { return static_cast<int32_t>(readUint32()); }
+    int64_t  readInt64()  const { return static_cast<int64_t>(readUint64()); }
+    float    readFloat()  const { return readNumber<float>(); }
+    double   readDouble() const { return readNumber<double>(); }
+
+    /// Reads numbers without range checking.
+    uint8_t  getUint8()  const noexcept { return getNumber<uint8_t>(); }
+    uint16_t getUint16() const noexcept { return getNumber<uint16_t>(); }
+    uint32_t getUint32() const noexcept { return getNumber<uint32_t>(); }
+    uint64_t getUint64() const noexcept { return getNumber<uint64_t>(); }
+    int8_t   getInt8()   const noexcept { return static_cast<int8_t>(getUint8()); }
+    int16_t  getInt16()  const noexcept { return static_cast<int16_t>(getUint16()); }
+    int32_t  getInt32()  const noexcept { return static_cast<int32_t>(getUint32()); }
+    int64_t  getInt64()  const noexcept { return static_cast<int64_t>(getUint64()); }
+    float    getFloat()  const noexcept { return getNumber<float>(); }
+    double   getDouble() const noexcept { return getNumber<double>(); }
+
+protected:
+    /// Points the view to other memory, keeping the cursor.
+    void reset(const uint8_t* data, size_t size) noexcept
+    {
+        view_data_ = data;
+        view_size_ = size;
+    }
+
+    /// Generic throwing numeric read function.
+    template <typename Number>
+    Number readNumber() const
+    {
+        checkRange(sizeof(Number));
+        return getNumber<Number>();
+    }
+
+    /// Generic non-throwing numeric read function.
+    template <typename Number>
+    Number getNumber() const noexcept
+    {
+        // memcpy keeps unaligned reads well-defined and compiles to a single load
+        Number value;
+        std::memcpy(&value, view_data_ + current_idx_, sizeof(Number));
+        current_idx_ += sizeof(Number);
+        return value;
+    }
+
+    /// Throws an std::out_of_range exception if trying to access an index beyond view range.
+    void checkRange(size_t n) const
+    {
+        if (n > remaining())
+            throw std::out_of_range("buffer: access beyond end");
+    }
+
+    const uint8_t* view_data_ = nullptr;
+    size_t view_size_ = 0;
+    mutable size_t current_idx_ = 0;
+};
+
+static_assert(sizeof(float) == 4, "float size is not 4 bytes");
+static_assert(sizeof(double) == 8, "double size is not 8 bytes");
+
+#endif // RO_BUFFERVIEW_HPP
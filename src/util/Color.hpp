@@ -12,6 +12,8 @@ struct Color {
     uint8_t r, g, b, a;
 };
 
+static_assert(sizeof(Color) == 4, "Color size is not 4 bytes");
+
 inline std::ostream& operator<<(std::ostream& out, const Color& color)
 {
     return out << "rgba(" 
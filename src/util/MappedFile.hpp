@@ -0,0 +1,114 @@
+#ifndef RO_MAPPEDFILE_HPP
+#define RO_MAPPEDFILE_HPP
+
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "BufferView.hpp"
+#include "filehandler.hpp"
+
+/**
+ * Read-only view of a memory-mapped file.
+ *
+ * Pages are loaded on demand from the kernel's page cache, so nothing is
+ * copied before a loader starts parsing.
+ */
+class MappedFile final : public BufferView {
+public:
+    /// Constructs an unmapped file.
+    explicit MappedFile() noexcept = default;
+
+    /**
+     * Maps a whole file into memory.
+     *
+     * @throws FileNotOpen if the file cannot be opened or mapped.
+     */
+    explicit MappedFile(const char* filename)
+    {
+        const int fd = ::open(filename, O_RDONLY);
+
+        if (fd < 0)
+            throw FileNotOpen(filename);
+
+        struct stat st;
+
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw FileNotOpen(filename);
+        }
+
+        const size_t size = static_cast<size_t>(st.st_size);
+
+        // Zero-length mappings are invalid, leave the view empty instead
+        if (size)
+        {
+            void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (addr == MAP_FAILED) {
+                ::close(fd);
+                throw FileNotOpen(filename);
+            }
+
+            ::madvise(addr, size, MADV_SEQUENTIAL);
+            reset(static_cast<const uint8_t*>(addr), size);
+        }
+
+        ::close(fd);
+    }
+
+    /// Move constructor.
+    MappedFile(MappedFile&& other) noexcept
+        : BufferView(other)
+    {
+        other.release();
+    }
+
+    /// No copy constructor.
+    MappedFile(const MappedFile&) = delete;
+
+    /// Unmaps the file.
+    ~MappedFile() { unmap(); }
+
+    /// Move assignment.
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap();
+            BufferView::operator=(other);
+            other.release();
+        }
+
+        return *this;
+    }
+
+    /// No copy assignment.
+    MappedFile& operator=(const MappedFile&) = delete;
+
+private:
+    void unmap() noexcept
+    {
+        if (view_data_)
+            ::munmap(const_cast<uint8_t*>(view_data_), view_size_);
+    }
+
+    void release() noexcept
+    {
+        reset(nullptr, 0);
+        current_idx_ = 0;
+    }
+};
+
+/**
+ * Maps a file into memory for reading.
+ *
+ * @throws FileNotOpen if the file cannot be opened or mapped.
+ */
+inline MappedFile mapFile(const char* filename)
+{
+    return MappedFile(filename);
+}
+
+#endif // RO_MAPPEDFILE_HPP
@@ -0,0 +1,38 @@
+#ifndef RO_MEMORYBUDGET_HPP
+#define RO_MEMORYBUDGET_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+/// Limits how many bytes tasks may hold in memory at once.
+class MemoryBudget final {
+public:
+    explicit MemoryBudget(size_t limit) : limit_{ limit } {}
+
+    /// Blocks until n bytes fit in the budget. A single oversized request is let through alone.
+    void acquire(size_t n)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&] { return in_use_ == 0 || in_use_ + n <= limit_; });
+        in_use_ += n;
+    }
+
+    void release(size_t n)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_use_ -= n;
+        }
+
+        cv_.notify_all();
+    }
+
+private:
+    const size_t limit_;
+    size_t in_use_ = 0;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+#endif // RO_MEMORYBUDGET_HPP
@@ -0,0 +1,36 @@
+#ifndef RO_SPAN_HPP
+#define RO_SPAN_HPP
+
+#include <cstddef>
+
+/**
+ * Contiguous sequence of elements owned elsewhere.
+ *
+ * The owner's storage must outlive the span.
+ */
+template <typename T>
+class Span {
+public:
+    /// Constructs an empty span.
+    constexpr Span() noexcept = default;
+
+    /// Constructs a span of size elements starting at data.
+    constexpr Span(T* data, size_t size) noexcept
+        : data_{ data }
+        , size_{ size } {}
+
+    constexpr T* data() const noexcept { return data_; }
+    constexpr size_t size() const noexcept { return size_; }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+
+    constexpr T& operator[](size_t i) const noexcept { return data_[i]; }
+
+    constexpr T* begin() const noexcept { return data_; }
+    constexpr T* end() const noexcept { return data_ + size_; }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+#endif // RO_SPAN_HPP
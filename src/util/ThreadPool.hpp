@@ -0,0 +1,189 @@
+#ifndef RO_THREADPOOL_HPP
+#define RO_THREADPOOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Work-stealing thread pool.
+ *
+ * Each worker owns a task queue. Tasks submitted from a worker go to its own
+ * queue and are taken newest first, while idle workers steal the oldest
+ * tasks from the others, so nested submissions stay local and load balances
+ * itself.
+ */
+class ThreadPool final {
+public:
+    /// Starts thread_count workers, or one per hardware thread if zero.
+    explicit ThreadPool(unsigned int thread_count = 0)
+    {
+        if (!thread_count)
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+        for (unsigned int i = 0; i < thread_count; i++)
+            workers_.emplace_back(std::make_unique<Worker>());
+
+        for (unsigned int i = 0; i < thread_count; i++)
+            threads_.emplace_back([this, i] { run(i); });
+    }
+
+    /// Runs all queued tasks and stops the workers.
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+
+        wake_cv_.notify_all();
+
+        for (std::thread& thread : threads_)
+            thread.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Number of worker threads.
+    size_t size() const noexcept { return threads_.size(); }
+
+    /// Queues a callable and returns a future for its result.
+    template <typename Function>
+    std::future<std::invoke_result_t<std::decay_t<Function>>> submit(Function&& function)
+    {
+        using Result = std::invoke_result_t<std::decay_t<Function>>;
+
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+        std::future<Result> result = task->get_future();
+
+        // Workers push to their own queue, other threads spread tasks round-robin
+        const size_t index = (current_pool_ == this) ?
+            current_index_ : next_queue_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+
+        unfinished_.fetch_add(1);
+
+        // Count the task before it can be taken, so queued_ never goes below zero
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queued_++;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+            workers_[index]->tasks.emplace_back([task] { (*task)(); });
+        }
+
+        wake_cv_.notify_one();
+        return result;
+    }
+
+    /// Blocks until every submitted task has finished. Must not be called from a worker.
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [this] { return unfinished_.load() == 0; });
+    }
+
+private:
+    using Task = std::function<void()>;
+
+    struct Worker {
+        std::deque<Task> tasks;
+        std::mutex mutex;
+    };
+
+    void run(size_t index)
+    {
+        current_pool_ = this;
+        current_index_ = index;
+
+        for (;;)
+        {
+            Task task;
+
+            if (popLocal(index, task) || steal(index, task))
+            {
+                task();
+
+                if (unfinished_.fetch_sub(1) == 1) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    done_cv_.notify_all();
+                }
+
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_cv_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+
+            if (stopping_ && queued_ == 0)
+                return;
+        }
+    }
+
+    /// Takes the newest task from a worker's own queue.
+    bool popLocal(size_t index, Task& task)
+    {
+        Worker& worker = *workers_[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+
+        if (worker.tasks.empty())
+            return false;
+
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        taken();
+        return true;
+    }
+
+    /// Takes the oldest task from another worker's queue.
+    bool steal(size_t index, Task& task)
+    {
+        for (size_t i = 1; i < workers_.size(); i++)
+        {
+            Worker& victim = *workers_[(index + i) % workers_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+
+            if (victim.tasks.empty())
+                continue;
+
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            taken();
+            return true;
+        }
+
+        return false;
+    }
+
+    void taken()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_--;
+    }
+
+    inline static thread_local const ThreadPool* current_pool_ = nullptr;
+    inline static thread_local size_t current_index_ = 0;
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> next_queue_{ 0 };
+    std::atomic<size_t> unfinished_{ 0 };
+
+    std::mutex mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable done_cv_;
+    size_t queued_ = 0;
+    bool stopping_ = false;
+};
+
+#endif // RO_THREADPOOL_HPP
@@ -0,0 +1,215 @@
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../src/format/Spr.hpp"
+#include "../src/format/ZeroRle.hpp"
+#include "../src/util/InvalidResource.hpp"
+
+using namespace std;
+using namespace format;
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            cout << __FILE__ << ':' << __LINE__ << ": check failed: " #cond << endl; \
+            failures++; \
+        } \
+    } while (0)
+
+/// Index buffer alternating literals and zero runs of random lengths, up to max_run.
+vector<uint8_t> makeIndices(mt19937& rng, size_t size, size_t max_run)
+{
+    vector<uint8_t> indices;
+    indices.reserve(size);
+
+    while (indices.size() < size)
+    {
+        const size_t left = size - indices.size();
+        const size_t run = min<size_t>(left, 1 + rng() % max_run);
+
+        if (rng() % 2)
+            indices.insert(indices.end(), run, 0);
+        else
+            for (size_t i = 0; i < run; i++)
+                indices.push_back(1 + rng() % 255);
+    }
+
+    return indices;
+}
+
+Spr makeSpr(mt19937& rng, uint8_t major, uint8_t minor)
+{
+    const int hex_version = (major << 8) | minor;
+
+    Spr spr;
+    spr.version = { major, minor };
+
+    const unsigned short sizes[][2] = { { 1, 1 }, { 7, 3 }, { 33, 64 }, { 120, 90 } };
+
+    for (const auto& size : sizes)
+    {
+        Spr::PaletteImage img{ size[0], size[1], {} };
+        const vector<uint8_t> indices = makeIndices(rng, static_cast<size_t>(size[0]) * size[1], 600);
+        img.indices.assign(indices.begin(), indices.end());
+        spr.palette_images.push_back(move(img));
+    }
+
+    if (hex_version >= 0x200)
+    {
+        for (const auto& size : sizes)
+        {
+            Spr::RgbaImage img{ size[0], size[1], {} };
+
+            for (size_t i = 0; i < static_cast<size_t>(size[0]) * size[1]; i++)
+                img.pixels.push_back(Color(static_cast<uint32_t>(rng())));
+
+            spr.rgba_images.push_back(move(img));
+        }
+    }
+
+    if (hex_version >= 0x101)
+    {
+        spr.pal = make_unique<Pal>();
+
+        for (Color& color : spr.pal->colors)
+            color = Color(static_cast<uint32_t>(rng()));
+    }
+
+    return spr;
+}
+
+vector<uint8_t> save(const Spr& spr)
+{
+    Buffer buf;
+    spr.save(buf);
+    return vector<uint8_t>(buf.data(), buf.data() + buf.size());
+}
+
+void testRoundTrip(mt19937& rng, uint8_t major, uint8_t minor)
+{
+    const Spr original = makeSpr(rng, major, minor);
+    const vector<uint8_t> saved = save(original);
+
+    const Spr loaded(BufferView(saved.data(), saved.size()));
+    CHECK(loaded.version.major == major && loaded.version.minor == minor);
+    CHECK(loaded.palette_images.size() == original.palette_images.size());
+    CHECK(loaded.rgba_images.size() == original.rgba_images.size());
+
+    for (size_t i = 0; i < min(loaded.palette_images.size(), original.palette_images.size()); i++)
+        CHECK(loaded.palette_images[i].indices == original.palette_images[i].indices);
+
+    CHECK(save(loaded) == saved);
+}
+
+void testEncoderPaths(mt19937& rng)
+{
+    const ZeroRleIsa isas[] = { ZeroRleIsa::Sse2, ZeroRleIsa::Avx2 };
+
+    for (int i = 0; i < 2000; i++)
+    {
+        const vector<uint8_t> src = makeIndices(rng, rng() % 2048, 1 + rng() % 600);
+
+        vector<uint8_t> expected(zeroRleBound(src.size()));
+        expected.resize(encodeZeroRle(ZeroRleIsa::Scalar, src.data(), src.size(), expected.data()));
+
+        for (ZeroRleIsa isa : isas)
+        {
+            if (!zeroRleSupported(isa))
+                continue;
+
+            vector<uint8_t> encoded(zeroRleBound(src.size()));
+            encoded.resize(encodeZeroRle(isa, src.data(), src.size(), encoded.data()));
+            CHECK(encoded == expected);
+        }
+
+        vector<uint8_t> decoded(src.size());
+        decodeZeroRle(expected.data(), expected.size(), decoded.data(), decoded.size());
+        CHECK(decoded == src);
+    }
+}
+
+void testLongZeroRuns()
+{
+    const struct {
+        size_t run;
+        vector<uint8_t> encoded;
+    } cases[] = {
+        { 1, { 0, 1 } },
+        { 255, { 0, 255 } },
+        { 256, { 0, 255, 0, 1 } },
+        { 600, { 0, 255, 0, 255, 0, 90 } },
+    };
+
+    for (const auto& c : cases)
+    {
+        const vector<uint8_t> src(c.run, 0);
+        vector<uint8_t> encoded(zeroRleBound(src.size()));
+        encoded.resize(encodeZeroRle(src.data(), src.size(), encoded.data()));
+        CHECK(encoded == c.encoded);
+    }
+}
+
+void testOversizedImage(mt19937& rng)
+{
+    // Nothing to compress, so 256x256 indices take 65536 bytes
+    Spr spr;
+    spr.version = { 2, 1 };
+    spr.pal = make_unique<Pal>();
+
+    Spr::PaletteImage img{ 256, 256, {} };
+
+    for (size_t i = 0; i < 256 * 256; i++)
+        img.indices.push_back(1 + rng() % 255);
+
+    spr.palette_images.push_back(move(img));
+
+    bool thrown = false;
+
+    try {
+        save(spr);
+    }
+    catch (const InvalidResource&) {
+        thrown = true;
+    }
+
+    CHECK(thrown);
+
+    // Stored raw, it fits
+    spr.version = { 2, 0 };
+    CHECK(save(spr).size() > 256 * 256);
+}
+
+} // namespace
+
+int main()
+{
+    mt19937 rng(1234);
+
+    try {
+        testRoundTrip(rng, 1, 0);
+        testRoundTrip(rng, 1, 1);
+        testRoundTrip(rng, 2, 0);
+        testRoundTrip(rng, 2, 1);
+        testEncoderPaths(rng);
+        testLongZeroRuns();
+        testOversizedImage(rng);
+    }
+    catch (const exception& e) {
+        cout << "Unexpected exception: " << e.what() << endl;
+        return 1;
+    }
+
+    if (failures)
+    {
+        cout << failures << " checks failed" << endl;
+        return 1;
+    }
+
+    cout << "All checks passed" << endl;
+    return 0;
+}